@@ -86,6 +86,28 @@ void IOBuffer_destroy(IOBuffer *self);
 BufferError IOBuffer_write(IOBuffer *const self, uint8_t const *const dataSrc,
                            size_t const dataSize);
 
+/**
+ * @brief Returns the largest contiguous free span starting at the write
+ * position, so that a producer can fill it in place (e.g. with read()) and
+ * publish it with IOBuffer_commitWrite. Must only be used by the single
+ * writer.
+ *
+ * @param[in] self: IOBuffer instance.
+ * @param[out] spanSize: Size in bytes of the free span, 0 if buffer is full.
+ *
+ * @return Pointer to the beginning of the free span.
+ */
+uint8_t *IOBuffer_reserveWrite(IOBuffer *const self, size_t *const spanSize);
+
+/**
+ * @brief Publishes dataSize bytes written in place into the span returned by
+ * IOBuffer_reserveWrite and wakes up sleeping readers.
+ *
+ * @param[in] self: IOBuffer instance.
+ * @param[in] dataSize: Number of bytes written, at most the reserved span.
+ */
+void IOBuffer_commitWrite(IOBuffer *const self, size_t const dataSize);
+
 /**
  * @brief Returns size in bytes of available data in the buffer.
  *
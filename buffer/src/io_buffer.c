@@ -118,6 +118,25 @@ BufferError IOBuffer_write(IOBuffer *const self, uint8_t const *const dataSrc,
   return err;
 }
 
+uint8_t *IOBuffer_reserveWrite(IOBuffer *const self, size_t *const spanSize) {
+  uintptr_t const readPos = self->readPos;
+  if (self->writePos < readPos) {
+    *spanSize = readPos - self->writePos - 1;
+  } else {
+    *spanSize = self->bufferSize - self->writePos - ((readPos == 0) ? 1 : 0);
+  }
+  return (uint8_t *)(self->bufferBegin + self->writePos);
+}
+
+void IOBuffer_commitWrite(IOBuffer *const self, size_t const dataSize) {
+  dassert(dataSize <= self->bufferSize);
+  uintptr_t writePos = self->writePos + dataSize;
+  self->writePos =
+      (writePos < self->bufferSize) ? writePos : writePos - self->bufferSize;
+  pthread_cond_broadcast(&self->readCond);
+  return;
+}
+
 BufferError IOBuffer_read(IOBuffer *const self, uint8_t *const dataDst,
                           size_t const dataSize) {
   BufferError err = {.result = 0, .errorCode = BUFFER_ERROR_OK};
@@ -192,7 +211,7 @@ BufferError IOBuffer_readAsync(IOBuffer *const self, uint8_t *const dataDst,
     err.result = dataSize - overflow;
     if (overflow) {
       size_t sizeToRead =
-          (self->writePos < dataSize) ? self->writePos : overflow;
+          (self->writePos < overflow) ? self->writePos : overflow;
       memcpy(dataDst + dataSize - overflow, (void *)(self->bufferBegin),
              sizeToRead);
       self->readPos = sizeToRead;
@@ -6,6 +6,36 @@ LIBS=()  # Paths to external libraries.
 
 # Global variables here.
 BUILD_DIR="build"
+TEST=false
+INCLUDE_DIRS=(
+    "./buffer/include"
+    "./dsp/include"
+    "./ingest/include"
+    "./render/include"
+)
+SOURCES=(
+    "main.c"
+    "./buffer/src/io_buffer.c"
+    "./dsp/src/autoset.c"
+    "./dsp/src/constellation.c"
+    "./dsp/src/decimate.c"
+    "./dsp/src/deep_memory.c"
+    "./dsp/src/envelope.c"
+    "./dsp/src/eye.c"
+    "./dsp/src/fft.c"
+    "./dsp/src/interpolate.c"
+    "./dsp/src/persistence.c"
+    "./dsp/src/roll.c"
+    "./dsp/src/segments.c"
+    "./dsp/src/spectrum.c"
+    "./dsp/src/trigger.c"
+    "./dsp/src/waterfall.c"
+    "./dsp/src/waveform_average.c"
+    "./ingest/src/shm_ingest.c"
+    "./ingest/src/stream_ingest.c"
+    "./ingest/src/unix_ingest.c"
+    "./render/src/framebuffer.c"
+)
 
 function set_up(){
     [[ -d "$BUILD_DIR/bin" ]] || mkdir -p "$BUILD_DIR/bin"
@@ -44,6 +74,26 @@ function signal_exit(){
     esac
 }
 
+function run_tests(){
+    # Each dsp/test/*_test.c is a program linked with the dsp sources, it
+    # exits with a non zero status when a check fails.
+    local dsp_sources=()
+    local source test name
+    for source in "${SOURCES[@]}"; do
+        [[ "$source" == ./dsp/src/* ]] && dsp_sources+=("$source")
+    done
+    mkdir -p "$BUILD_DIR/test"
+    for test in ./dsp/test/*_test.c; do
+        name=$(basename "$test" .c)
+        gcc -ggdb -O2 "${INCLUDE_DIRS[@]/#/-I}" "$test" "${dsp_sources[@]}" \
+            -lm -lpthread -o "$BUILD_DIR/test/$name" \
+            || error_exit "Failed to build $name."
+        "$BUILD_DIR/test/$name" || error_exit "$name failed."
+        printf "%s: ok\n" "$name"
+    done
+    return 0
+}
+
 function load_libs(){
     local i
     for i in $LIBS; do
@@ -69,6 +119,7 @@ $(usage)
 Otions:
 -h, --help              Display this help message.
 -b, --build-dir <DIR>   Path to build directory (defaults to cwd/build).
+-t, --test              Build and run the dsp tests instead.
 
 EOF
     return 0
@@ -89,6 +140,9 @@ while [[ -n "$1" ]]; do
             shift
             BUILD_DIR="$1"
             ;;
+        -t | --test)
+            TEST=true
+            ;;
         -* | --*)
             usage >&2
             error_exit "Unknown option $1"
@@ -103,7 +157,12 @@ done
 
 set_up
 
-gcc -ggdb -I./buffer/include main.c ./buffer/src/io_buffer.c -lraylib -lm -o "$BUILD_DIR/bin/oscilloscope"
+if [[ "$TEST" == true ]]; then
+    run_tests
+    graceful_exit
+fi
+
+gcc -ggdb -O2 "${INCLUDE_DIRS[@]/#/-I}" "${SOURCES[@]}" -lraylib -lm -lrt -o "$BUILD_DIR/bin/oscilloscope"
 go build -o "$BUILD_DIR/bin/signal-generator" signal_generator/signal_generator.go
 
 graceful_exit
@@ -0,0 +1,93 @@
+
+#pragma once
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define AUTOSET_BLOCK_FRAMES 4096
+#define AUTOSET_HISTORY 16
+
+/**
+ * Incremental amplitude and period estimators of the first channel, cheap
+ * enough to follow the whole stream. The stream is cut in blocks of
+ * AUTOSET_BLOCK_FRAMES frames, each one summarized by its minimum, maximum
+ * and rising crossings of the mid level; estimates combine the last
+ * AUTOSET_HISTORY blocks, so they forget a signal that changed.
+ */
+typedef struct {
+  float min;
+  float max;
+  double period; // Frames between rising crossings, 0 when unknown.
+} AutosetEstimate;
+
+typedef struct {
+  // Completed blocks, a ring of AUTOSET_HISTORY.
+  float blockMin[AUTOSET_HISTORY];
+  float blockMax[AUTOSET_HISTORY];
+  uint32_t blockCrossings[AUTOSET_HISTORY]; // Intervals measured.
+  double blockIntervals[AUTOSET_HISTORY];   // Their sum in frames.
+  size_t blocks;
+  size_t next;
+  // Block being filled.
+  size_t frames;
+  float min;
+  float max;
+  uint32_t crossings;
+  double intervals;
+  // Crossing detector, thresholds follow the completed blocks.
+  float level;
+  float hysteresis;
+  bool armed; // Went below level - hysteresis since the last crossing.
+  bool hasCrossing;
+  double lastCrossing;
+  float last;
+  uint64_t frame; // Frames processed.
+  pthread_mutex_t mutex;
+} Autoset;
+
+/* ============================================ Public functions declaration */
+
+/**
+ * @brief Creates new estimators. Allocates memory that must be freed with
+ * Autoset_destroy.
+ *
+ * @return Autoset instance, NULL if memory allocation errors.
+ */
+Autoset *Autoset_create(void);
+
+/**
+ * @brief Destroys instance. Frees all allocated memory during creation.
+ *
+ * @param[in] self: Autoset instance.
+ */
+void Autoset_destroy(Autoset *self);
+
+/**
+ * @brief Drops the history, e.g. when the stream is interrupted.
+ *
+ * @param[in] self: Autoset instance.
+ */
+void Autoset_reset(Autoset *const self);
+
+/**
+ * @brief Updates the estimators with consecutive frames of the stream.
+ *
+ * @param[in] self: Autoset instance.
+ * @param[in] src: Interleaved samples, frames * channels values.
+ * @param[in] frames: Number of frames in src.
+ * @param[in] channels: Number of interleaved channels, only the first one is
+ * read.
+ */
+void Autoset_process(Autoset *const self, float const *const src,
+                     size_t const frames, size_t const channels);
+
+/**
+ * @brief Reads the current estimates.
+ *
+ * @param[in] self: Autoset instance.
+ * @param[out] estimate: Amplitude range and period.
+ * @return false while no frame has been processed.
+ */
+bool Autoset_estimate(Autoset *const self, AutosetEstimate *const estimate);
@@ -0,0 +1,79 @@
+
+#pragma once
+
+#include "dsp/persistence.h"
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * IQ constellation: density of the first channel (I) against the second one
+ * (Q). Either every frame is plotted, or with a nominal symbol length only
+ * one point per symbol, at instants tracked by a Gardner timing loop on
+ * linearly interpolated samples.
+ */
+typedef struct {
+  double samplesPerSymbol; // 0 plots every frame.
+  Persistence *map;
+  // Symbol timing state, times in frames relative to the current chunk.
+  bool hasLast;
+  float last[2];
+  double nextMid;
+  double nextStrobe;
+  bool hasStrobe;
+  float strobe[2];
+  float mid[2];
+  float *x;
+  float *y;
+  pthread_mutex_t mutex;
+} Constellation;
+
+/* ============================================ Public functions declaration */
+
+/**
+ * @brief Creates a new constellation. Allocates memory that must be freed
+ * with Constellation_destroy.
+ *
+ * @param[in] width: Number of map columns.
+ * @param[in] height: Number of map rows.
+ * @param[in] samplesPerSymbol: Nominal frames per symbol, 0 to plot every
+ * frame.
+ * @return Constellation instance, NULL if memory allocation errors.
+ */
+Constellation *Constellation_create(size_t const width, size_t const height,
+                                    double const samplesPerSymbol);
+
+/**
+ * @brief Destroys instance. Frees all allocated memory during creation.
+ *
+ * @param[in] self: Constellation instance.
+ */
+void Constellation_destroy(Constellation *self);
+
+/**
+ * @brief Drops the symbol timing and the map.
+ *
+ * @param[in] self: Constellation instance.
+ */
+void Constellation_reset(Constellation *const self);
+
+/**
+ * @brief Drops the symbol timing only, for a stream resuming after a gap.
+ *
+ * @param[in] self: Constellation instance.
+ */
+void Constellation_resync(Constellation *const self);
+
+/**
+ * @brief Adds consecutive frames to the map. Both axes span [min, max].
+ *
+ * @param[in] self: Constellation instance.
+ * @param[in] src: Interleaved samples, frames * channels values.
+ * @param[in] frames: Number of frames in src.
+ * @param[in] channels: Number of interleaved channels, at least 2.
+ * @param[in] min: Value mapped to the left column and the bottom row.
+ * @param[in] max: Value mapped to the right column and the top row.
+ */
+void Constellation_process(Constellation *const self, float const *const src,
+                           size_t const frames, size_t const channels,
+                           float const min, float const max);
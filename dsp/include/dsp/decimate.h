@@ -0,0 +1,63 @@
+
+#pragma once
+
+#include <stddef.h>
+
+typedef enum {
+  DECIMATE_PEAK, // Min/max per column, never hides glitches.
+  DECIMATE_LTTB, // Largest-Triangle-Three-Buckets, for smooth analog traces.
+  DECIMATE_RMS   // Mean +/- RMS deviation per column, for noisy captures.
+} DecimateMode;
+
+/* ============================================ Public functions declaration */
+
+/**
+ * @brief Peak-detect decimation. Splits frames into columns equal ranges and
+ * keeps the minimum and maximum of every channel in each range, so that no
+ * glitch is lost whatever the decimation ratio. Samples are interleaved by
+ * channel (e.g. I/Q pairs for two channels).
+ *
+ * @param[in] src: Interleaved samples, frames * channels values.
+ * @param[in] frames: Number of frames in src, must be >= columns.
+ * @param[in] channels: Number of interleaved channels, 1, 2 or 4.
+ * @param[in] columns: Number of output columns (usually pixels).
+ * @param[out] outMin: Per column minimum, columns * channels values.
+ * @param[out] outMax: Per column maximum, columns * channels values.
+ */
+void Decimate_minMax(float const *const src, size_t const frames,
+                     size_t const channels, size_t const columns,
+                     float *const outMin, float *const outMax);
+
+/**
+ * @brief RMS decimation. Splits frames into columns equal ranges and returns
+ * for every channel the band mean - rms and mean + rms of each range, where
+ * rms is the RMS deviation from the range mean. The band can be drawn like
+ * the peak-detect output.
+ *
+ * @param[in] src: Interleaved samples, frames * channels values.
+ * @param[in] frames: Number of frames in src, must be >= columns.
+ * @param[in] channels: Number of interleaved channels, 1, 2 or 4.
+ * @param[in] columns: Number of output columns (usually pixels).
+ * @param[out] outLow: Per column mean - rms, columns * channels values.
+ * @param[out] outHigh: Per column mean + rms, columns * channels values.
+ */
+void Decimate_rms(float const *const src, size_t const frames,
+                  size_t const channels, size_t const columns,
+                  float *const outLow, float *const outHigh);
+
+/**
+ * @brief Largest-Triangle-Three-Buckets decimation. Keeps first and last
+ * frame and, for each of the columns - 2 buckets in between, the frame that
+ * forms the largest triangle with the previously kept point and the average
+ * of the next bucket. Single O(frames) pass per channel.
+ *
+ * @param[in] src: Interleaved samples, frames * channels values.
+ * @param[in] frames: Number of frames in src, must be >= columns.
+ * @param[in] channels: Number of interleaved channels, 1, 2 or 4.
+ * @param[in] columns: Number of output points per channel, must be >= 3.
+ * @param[out] outX: Frame index of each kept point, columns * channels values.
+ * @param[out] outY: Value of each kept point, columns * channels values.
+ */
+void Decimate_lttb(float const *const src, size_t const frames,
+                   size_t const channels, size_t const columns,
+                   float *const outX, float *const outY);
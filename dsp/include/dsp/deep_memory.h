@@ -0,0 +1,122 @@
+
+#pragma once
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define DEEP_MEMORY_BASE_BLOCK 64
+#define DEEP_MEMORY_LEVEL_FACTOR 8
+#define DEEP_MEMORY_MAX_LEVELS 8
+
+/**
+ * Acquisition memory keeping the last capacity frames of the stream, plus a
+ * min/max pyramid over it. Level 0 holds one min/max entry per
+ * DEEP_MEMORY_BASE_BLOCK frames, each next level merges
+ * DEEP_MEMORY_LEVEL_FACTOR entries of the previous one. Frames are addressed
+ * by their absolute index since the last reset.
+ */
+typedef struct {
+  float *samples;
+  size_t capacity;
+  size_t channels;
+  uint64_t total;
+  size_t levels;
+  size_t blockFrames[DEEP_MEMORY_MAX_LEVELS];
+  float *levelMin[DEEP_MEMORY_MAX_LEVELS];
+  float *levelMax[DEEP_MEMORY_MAX_LEVELS];
+  pthread_mutex_t mutex;
+  pthread_cond_t written; // Signaled by every write.
+} DeepMemory;
+
+/* ============================================ Public functions declaration */
+
+/**
+ * @brief Creates a new memory. Allocates memory that must be freed with
+ * DeepMemory_destroy.
+ *
+ * @param[in] sizeBytes: Sample storage size in bytes, rounded down to a whole
+ * number of top level blocks. The pyramid adds about 4% on top of it.
+ * @param[in] channels: Number of interleaved channels per frame, 1, 2 or 4.
+ * @return DeepMemory instance, NULL if memory allocation errors.
+ */
+DeepMemory *DeepMemory_create(size_t const sizeBytes, size_t const channels);
+
+/**
+ * @brief Destroys instance. Frees all allocated memory during creation.
+ *
+ * @param[in] self: DeepMemory instance.
+ */
+void DeepMemory_destroy(DeepMemory *self);
+
+/**
+ * @brief Drops all stored frames.
+ *
+ * @param[in] self: DeepMemory instance.
+ */
+void DeepMemory_reset(DeepMemory *const self);
+
+/**
+ * @brief Appends frames, overwriting the oldest ones once full, and updates
+ * the pyramid for every block completed by the write.
+ *
+ * @param[in] self: DeepMemory instance.
+ * @param[in] frames: Interleaved samples, frameCount * channels values.
+ * @param[in] frameCount: Number of frames to append.
+ */
+void DeepMemory_write(DeepMemory *const self, float const *const frames,
+                      size_t const frameCount);
+
+/**
+ * @brief Returns the range of frames currently stored.
+ *
+ * @param[in] self: DeepMemory instance.
+ * @param[out] oldest: Absolute index of the oldest stored frame.
+ * @return Absolute index one past the newest stored frame.
+ */
+uint64_t DeepMemory_range(DeepMemory *const self, uint64_t *const oldest);
+
+/**
+ * @brief Sleeps until frames past newest are stored, or for at most
+ * timeoutNs nanoseconds.
+ *
+ * @param[in] self: DeepMemory instance.
+ * @param[in] newest: Absolute index one past the newest frame already seen.
+ * @param[in] timeoutNs: Longest sleep in nanoseconds.
+ * @return Absolute index one past the newest stored frame.
+ */
+uint64_t DeepMemory_wait(DeepMemory *const self, uint64_t const newest,
+                         long const timeoutNs);
+
+/**
+ * @brief Copies frames [first, first + frameCount) to dst. The range is
+ * checked under the lock, a writer may have overwritten it since
+ * DeepMemory_range.
+ *
+ * @param[in] self: DeepMemory instance.
+ * @param[in] first: Absolute index of the first frame to copy.
+ * @param[in] frameCount: Number of frames to copy, at most capacity.
+ * @param[out] dst: Destination, frameCount * channels values.
+ * @return false, with dst untouched, if the range is not stored.
+ */
+bool DeepMemory_copy(DeepMemory *const self, uint64_t const first,
+                     size_t const frameCount, float *const dst);
+
+/**
+ * @brief Peak-detect view of frames [first, first + frameCount), same output
+ * as Decimate_minMax. Each column is assembled from the coarsest pyramid
+ * entries that fit in it, so the cost does not depend on frameCount. The
+ * range is checked under the lock like in DeepMemory_copy.
+ *
+ * @param[in] self: DeepMemory instance.
+ * @param[in] first: Absolute index of the first frame.
+ * @param[in] frameCount: Number of frames, >= columns and at most capacity.
+ * @param[in] columns: Number of output columns.
+ * @param[out] outMin: Per column minimum, columns * channels values.
+ * @param[out] outMax: Per column maximum, columns * channels values.
+ * @return false, with the outputs untouched, if the range is not stored.
+ */
+bool DeepMemory_reduce(DeepMemory *const self, uint64_t const first,
+                       size_t const frameCount, size_t const columns,
+                       float *const outMin, float *const outMax);
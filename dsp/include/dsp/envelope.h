@@ -0,0 +1,76 @@
+
+#pragma once
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * Envelope of trigger aligned waveforms: the running minimum and maximum of
+ * every sample position over all the windows added since the last reset,
+ * which shows jitter and amplitude drift over many acquisitions. The
+ * acquisition thread adds waveforms, the display reads the envelope reduced
+ * to its columns.
+ */
+typedef struct {
+  size_t columns;  // Largest number of points read at once.
+  size_t frames;   // Frames per waveform, 0 until the first one.
+  size_t channels;
+  size_t acquired; // Waveforms added since the last reset.
+  float *min;      // frames * channels values.
+  float *max;      // frames * channels values.
+  float *scratch;  // columns * channels values, reduction output.
+  pthread_mutex_t mutex;
+} Envelope;
+
+/* ============================================ Public functions declaration */
+
+/**
+ * @brief Creates a new, empty, envelope. Allocates memory that must be freed
+ * with Envelope_destroy.
+ *
+ * @param[in] columns: Largest number of points read at once (usually screen
+ * pixels).
+ * @param[in] channels: Number of interleaved channels, 1, 2 or 4.
+ * @return Envelope instance, NULL if memory allocation errors.
+ */
+Envelope *Envelope_create(size_t const columns, size_t const channels);
+
+/**
+ * @brief Destroys instance. Frees all allocated memory during creation.
+ *
+ * @param[in] self: Envelope instance.
+ */
+void Envelope_destroy(Envelope *self);
+
+/**
+ * @brief Drops every waveform added so far.
+ *
+ * @param[in] self: Envelope instance.
+ */
+void Envelope_reset(Envelope *const self);
+
+/**
+ * @brief Widens the envelope with a waveform. The envelope restarts when the
+ * waveform length changes.
+ *
+ * @param[in] self: Envelope instance.
+ * @param[in] src: Waveform, interleaved samples, frames * channels values.
+ * @param[in] frames: Number of frames in src.
+ * @return false if memory allocation errors.
+ */
+bool Envelope_add(Envelope *const self, float const *const src,
+                  size_t const frames);
+
+/**
+ * @brief Reads the envelope, one point per frame when there are at most
+ * columns frames, otherwise the extremes of columns equal ranges of frames.
+ *
+ * @param[in] self: Envelope instance.
+ * @param[out] outMin: Lower edge, columns * channels values, interleaved.
+ * @param[out] outMax: Upper edge, columns * channels values, interleaved.
+ * @param[out] acquired: Waveforms added since the last reset.
+ * @return Number of points per channel, 0 when the envelope is empty.
+ */
+size_t Envelope_read(Envelope *const self, float *const outMin,
+                     float *const outMax, size_t *const acquired);
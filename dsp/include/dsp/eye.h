@@ -0,0 +1,116 @@
+
+#pragma once
+
+#include "dsp/persistence.h"
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define EYE_TRAINING_CROSSINGS 64
+
+/**
+ * Eye diagram of a serial stream on the first channel. The symbol clock is
+ * recovered from the crossings of threshold: without a nominal unit interval
+ * the shortest spacing between crossings seeds it, then a second order loop
+ * tracks phase and rate (phase only with a fixed unit interval). The stream
+ * is folded on two unit intervals, a crossing drawn at 1/4 and 3/4 of the
+ * width and the eye opening in the middle.
+ */
+typedef struct {
+  float threshold;  // Decision level, its crossings carry the clock.
+  double nominalUi; // Frames per unit interval, 0 to recover it.
+  Persistence *map;
+  // Clock recovery state, times in frames since the last reset.
+  double ui; // Frames per unit interval, 0 while training.
+  double trainedUi;
+  double phase; // Time of the last symbol boundary.
+  bool phaseValid;
+  uint64_t time; // Time of the next frame.
+  bool hasLast;
+  float last;
+  bool hasCrossing;
+  double lastCrossing;
+  double intervals[EYE_TRAINING_CROSSINGS];
+  size_t intervalCount;
+  // Measurement accumulators.
+  double crossingSum;
+  double crossingSquares;
+  uint64_t crossings;
+  double highSum;
+  double highSquares;
+  uint64_t highs;
+  double lowSum;
+  double lowSquares;
+  uint64_t lows;
+  float *x;
+  float *y;
+  pthread_mutex_t mutex;
+} EyeDiagram;
+
+typedef struct {
+  bool locked;
+  double ui;     // Recovered frames per unit interval.
+  float height;  // Inner eye opening, (high - 3 sigma) - (low + 3 sigma).
+  double width;  // Unit interval minus 6 sigma of crossing jitter, in UI.
+  double jitter; // RMS crossing jitter, in frames.
+} EyeMeasurement;
+
+/* ============================================ Public functions declaration */
+
+/**
+ * @brief Creates a new eye diagram. Allocates memory that must be freed with
+ * EyeDiagram_destroy.
+ *
+ * @param[in] width: Number of map columns (usually screen pixels).
+ * @param[in] height: Number of map rows (usually screen pixels).
+ * @param[in] nominalUi: Frames per unit interval, 0 to recover it.
+ * @return EyeDiagram instance, NULL if memory allocation errors.
+ */
+EyeDiagram *EyeDiagram_create(size_t const width, size_t const height,
+                              double const nominalUi);
+
+/**
+ * @brief Destroys instance. Frees all allocated memory during creation.
+ *
+ * @param[in] self: EyeDiagram instance.
+ */
+void EyeDiagram_destroy(EyeDiagram *self);
+
+/**
+ * @brief Drops the clock lock, the measurements and the map.
+ *
+ * @param[in] self: EyeDiagram instance.
+ */
+void EyeDiagram_reset(EyeDiagram *const self);
+
+/**
+ * @brief Recovers the clock over consecutive frames and folds them into the
+ * map. Must be fed the whole stream, call EyeDiagram_resync after a gap.
+ *
+ * @param[in] self: EyeDiagram instance.
+ * @param[in] src: Interleaved samples, frames * channels values.
+ * @param[in] frames: Number of frames in src.
+ * @param[in] channels: Number of interleaved channels, the first is used.
+ * @param[in] yMin: Value mapped to the bottom row of the map.
+ * @param[in] yMax: Value mapped to the top row of the map.
+ */
+void EyeDiagram_process(EyeDiagram *const self, float const *const src,
+                        size_t const frames, size_t const channels,
+                        float const yMin, float const yMax);
+
+/**
+ * @brief Drops the symbol phase but keeps the rate, the measurements and the
+ * map, for a stream resuming after a gap.
+ *
+ * @param[in] self: EyeDiagram instance.
+ */
+void EyeDiagram_resync(EyeDiagram *const self);
+
+/**
+ * @brief Returns the eye measurements since the last reset.
+ *
+ * @param[in] self: EyeDiagram instance.
+ * @param[out] out: Measurements.
+ */
+void EyeDiagram_measure(EyeDiagram *const self, EyeMeasurement *const out);
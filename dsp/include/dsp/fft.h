@@ -0,0 +1,95 @@
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#define FFT_MAX_STAGES 16
+
+/**
+ * Complex FFT plan for one power of two size. The transform is a Stockham
+ * autosort FFT (no bit reversal pass) made of radix-4 passes, plus one
+ * radix-2 pass for odd powers of two. Data is kept in split format, real and
+ * imaginary parts in separate arrays, so that every pass runs on four
+ * butterflies per SSE instruction. Twiddles are computed once per plan.
+ */
+typedef struct {
+  size_t size;
+  size_t stages; // Radix-4 passes.
+  bool radix2;   // Trailing radix-2 pass.
+  float *twiddleRe[FFT_MAX_STAGES];
+  float *twiddleIm[FFT_MAX_STAGES];
+  float *workRe;
+  float *workIm;
+} FftPlan;
+
+/**
+ * Real input FFT plan: a size real transform computed with a size / 2
+ * complex transform on the even/odd samples, followed by a split pass.
+ */
+typedef struct {
+  size_t size;
+  FftPlan *half;
+  float *splitRe;
+  float *splitIm;
+  float *re;
+  float *im;
+} RealFftPlan;
+
+/* ============================================ Public functions declaration */
+
+/**
+ * @brief Creates a complex FFT plan. Allocates memory that must be freed with
+ * FftPlan_destroy.
+ *
+ * @param[in] size: Transform size, a power of two >= 2.
+ * @return FftPlan instance, NULL if size is invalid or memory allocation
+ * errors.
+ */
+FftPlan *FftPlan_create(size_t const size);
+
+/**
+ * @brief Destroys instance. Frees all allocated memory during creation.
+ *
+ * @param[in] self: FftPlan instance.
+ */
+void FftPlan_destroy(FftPlan *self);
+
+/**
+ * @brief Forward transform in place, X[k] = sum x[n] exp(-2 pi i n k / size).
+ * A plan holds scratch memory, it must not be shared between threads.
+ *
+ * @param[in] self: FftPlan instance.
+ * @param[in,out] re: Real parts, size values.
+ * @param[in,out] im: Imaginary parts, size values.
+ */
+void FftPlan_forward(FftPlan *const self, float *const re, float *const im);
+
+/**
+ * @brief Creates a real input FFT plan. Allocates memory that must be freed
+ * with RealFftPlan_destroy.
+ *
+ * @param[in] size: Transform size, a power of two >= 4.
+ * @return RealFftPlan instance, NULL if size is invalid or memory allocation
+ * errors.
+ */
+RealFftPlan *RealFftPlan_create(size_t const size);
+
+/**
+ * @brief Destroys instance. Frees all allocated memory during creation.
+ *
+ * @param[in] self: RealFftPlan instance.
+ */
+void RealFftPlan_destroy(RealFftPlan *self);
+
+/**
+ * @brief Forward transform of real samples, returns the size / 2 + 1 non
+ * negative frequency bins.
+ *
+ * @param[in] self: RealFftPlan instance.
+ * @param[in] src: Real samples, size values.
+ * @param[out] outRe: Real parts, size / 2 + 1 values.
+ * @param[out] outIm: Imaginary parts, size / 2 + 1 values.
+ */
+void RealFftPlan_forward(RealFftPlan *const self, float const *const src,
+                         float *const outRe, float *const outIm);
@@ -0,0 +1,63 @@
+
+#pragma once
+
+#include <stddef.h>
+
+#define INTERPOLATE_TAPS 32
+#define INTERPOLATE_MAX_POINTS 64
+
+/**
+ * Band-limited sin(x)/x interpolator. Every output point between two samples
+ * is a Blackman windowed sinc FIR of the INTERPOLATE_TAPS nearest samples,
+ * whose coefficients only depend on the point position between samples: they
+ * are precomputed once per position (polyphase table). Unlike straight
+ * segments, a tone close to Nyquist is reconstructed with its true shape.
+ */
+typedef struct {
+  size_t points;    // Output points per input sample.
+  size_t maxFrames; // Largest src accepted by Interpolator_run.
+  float *table;     // table[tap * points + phase].
+  float *line;      // One channel of src, edges held over the taps.
+} Interpolator;
+
+/* ============================================ Public functions declaration */
+
+/**
+ * @brief Creates a new interpolator. Allocates memory that must be freed with
+ * Interpolator_destroy.
+ *
+ * @param[in] points: Output points per input sample, in [1,
+ * INTERPOLATE_MAX_POINTS].
+ * @param[in] maxFrames: Largest number of frames given to Interpolator_run.
+ * @return Interpolator instance, NULL if memory allocation errors.
+ */
+Interpolator *Interpolator_create(size_t const points,
+                                  size_t const maxFrames);
+
+/**
+ * @brief Destroys instance. Frees all allocated memory during creation.
+ *
+ * @param[in] self: Interpolator instance.
+ */
+void Interpolator_destroy(Interpolator *self);
+
+/**
+ * @brief Interpolates frames [first, first + count) of src, count >= 1.
+ * Frames of src around that range are only read as filter context, so the
+ * caller passes up to INTERPOLATE_TAPS / 2 extra frames on each side when it
+ * has them; beyond src the edge frames are held.
+ *
+ * @param[in] self: Interpolator instance.
+ * @param[in] src: Interleaved samples, frames * channels values.
+ * @param[in] frames: Number of frames in src, at most maxFrames.
+ * @param[in] channels: Number of interleaved channels.
+ * @param[in] first: First interpolated frame of src.
+ * @param[in] count: Number of interpolated frames.
+ * @param[out] dst: Channel after channel, (count - 1) * points + 1 values
+ * each, the first one at frame first, then every 1 / points frame.
+ * @return Number of values written per channel.
+ */
+size_t Interpolator_run(Interpolator *const self, float const *const src,
+                        size_t const frames, size_t const channels,
+                        size_t const first, size_t const count,
+                        float *const dst);
@@ -0,0 +1,104 @@
+
+#pragma once
+
+#include <pthread.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define PERSISTENCE_PALETTE_SIZE 256
+
+/**
+ * Digital phosphor: a width x height hit-count histogram every acquired
+ * waveform is drawn into. Counts are stored column by column so that the
+ * vertical span a waveform covers in one column is contiguous. Decay is a
+ * multiplication of the whole histogram, skipping it gives infinite
+ * persistence.
+ */
+typedef struct {
+  size_t width;
+  size_t height;
+  float *hits; // hits[x * height + y], row 0 is the top of the screen.
+  int32_t *rows;
+  uint8_t palette[PERSISTENCE_PALETTE_SIZE][4];
+  uint64_t waveforms;
+  pthread_mutex_t mutex;
+} Persistence;
+
+/* ============================================ Public functions declaration */
+
+/**
+ * @brief Creates a new histogram. Allocates memory that must be freed with
+ * Persistence_destroy.
+ *
+ * @param[in] width: Number of columns (usually screen pixels).
+ * @param[in] height: Number of rows (usually screen pixels).
+ * @return Persistence instance, NULL if memory allocation errors.
+ */
+Persistence *Persistence_create(size_t const width, size_t const height);
+
+/**
+ * @brief Destroys instance. Frees all allocated memory during creation.
+ *
+ * @param[in] self: Persistence instance.
+ */
+void Persistence_destroy(Persistence *self);
+
+/**
+ * @brief Clears the histogram.
+ *
+ * @param[in] self: Persistence instance.
+ */
+void Persistence_clear(Persistence *const self);
+
+/**
+ * @brief Adds one waveform. Frames are spread evenly over the columns and
+ * every channel is drawn as a connected trace, each pixel it crosses gets
+ * one hit.
+ *
+ * @param[in] self: Persistence instance.
+ * @param[in] src: Interleaved samples, frames * channels values.
+ * @param[in] frames: Number of frames in src.
+ * @param[in] channels: Number of interleaved channels.
+ * @param[in] yMin: Value mapped to the bottom row.
+ * @param[in] yMax: Value mapped to the top row.
+ */
+void Persistence_accumulate(Persistence *const self, float const *const src,
+                            size_t const frames, size_t const channels,
+                            float const yMin, float const yMax);
+
+/**
+ * @brief Adds a cloud of points, each one hits the pixel it falls in. Points
+ * outside [xMin, xMax) x [yMin, yMax) are dropped.
+ *
+ * @param[in] self: Persistence instance.
+ * @param[in] x: Horizontal coordinates, count values.
+ * @param[in] y: Vertical coordinates, count values.
+ * @param[in] count: Number of points.
+ * @param[in] xMin: Value mapped to the left column.
+ * @param[in] xMax: Value mapped past the right column.
+ * @param[in] yMin: Value mapped to the bottom row.
+ * @param[in] yMax: Value mapped to the top row.
+ */
+void Persistence_accumulatePoints(Persistence *const self,
+                                  float const *const x, float const *const y,
+                                  size_t const count, float const xMin,
+                                  float const xMax, float const yMin,
+                                  float const yMax);
+
+/**
+ * @brief Fades the histogram, multiplying every count by factor.
+ *
+ * @param[in] self: Persistence instance.
+ * @param[in] factor: Decay factor in [0, 1], e.g. exp(-dt / tau).
+ */
+void Persistence_decay(Persistence *const self, float const factor);
+
+/**
+ * @brief Grades the histogram into an RGBA8 image, row major with row 0 at
+ * the top. Intensity follows the logarithm of the count relative to the
+ * highest count, pixels never hit are fully transparent.
+ *
+ * @param[in] self: Persistence instance.
+ * @param[out] rgba: Output pixels, width * height * 4 bytes.
+ */
+void Persistence_render(Persistence *const self, uint8_t *const rgba);
@@ -0,0 +1,75 @@
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define ROLL_MAX_CHANNELS 4
+
+/**
+ * Chart recorder image: a ring of width pixel columns, each one drawn once
+ * from the min/max of the frames it covers. Pixels are stored column by
+ * column so that a new column is a contiguous height * 4 bytes block that
+ * can be uploaded on its own. Scrolling is left to the consumer, which
+ * draws the ring in two parts split after the newest column.
+ */
+typedef struct {
+  size_t width;
+  size_t height;
+  size_t channels;
+  uint8_t *pixels; // pixels[(x * height + y) * 4], row 0 is the top.
+  uint8_t colors[ROLL_MAX_CHANNELS][4];
+  int32_t lastTop[ROLL_MAX_CHANNELS];
+  int32_t lastBottom[ROLL_MAX_CHANNELS];
+  bool hasLast;
+} RollChart;
+
+/* ============================================ Public functions declaration */
+
+/**
+ * @brief Creates a new chart, fully transparent. Allocates memory that must
+ * be freed with RollChart_destroy.
+ *
+ * @param[in] width: Number of columns (usually screen pixels).
+ * @param[in] height: Number of rows (usually screen pixels).
+ * @param[in] channels: Number of channels drawn in each column.
+ * @param[in] colors: RGBA color of each channel, channels values.
+ * @return RollChart instance, NULL if memory allocation errors.
+ */
+RollChart *RollChart_create(size_t const width, size_t const height,
+                            size_t const channels,
+                            uint8_t const (*const colors)[4]);
+
+/**
+ * @brief Destroys instance. Frees all allocated memory during creation.
+ *
+ * @param[in] self: RollChart instance.
+ */
+void RollChart_destroy(RollChart *self);
+
+/**
+ * @brief Clears every column. The next column drawn is not joined to the
+ * previous one.
+ *
+ * @param[in] self: RollChart instance.
+ */
+void RollChart_clear(RollChart *const self);
+
+/**
+ * @brief Draws the next column of the chart into ring column x. Each channel
+ * fills the rows between its minimum and maximum, stretched to touch the
+ * previous column so that the trace stays connected.
+ *
+ * @param[in] self: RollChart instance.
+ * @param[in] x: Ring column, in [0, width).
+ * @param[in] columnMin: Minimum of every channel, channels values.
+ * @param[in] columnMax: Maximum of every channel, channels values.
+ * @param[in] yMin: Value mapped to the bottom row.
+ * @param[in] yMax: Value mapped to the top row.
+ * @return Column pixels, height * 4 bytes, row 0 first.
+ */
+uint8_t const *RollChart_draw(RollChart *const self, size_t const x,
+                              float const *const columnMin,
+                              float const *const columnMax, float const yMin,
+                              float const yMax);
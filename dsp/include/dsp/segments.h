@@ -0,0 +1,95 @@
+
+#pragma once
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+
+#define SEGMENTS_MAX_COUNT 10000
+// Storage limit, count * frames * channels floats.
+#define SEGMENTS_MAX_SAMPLES (64 * 1024 * 1024)
+
+typedef struct {
+  uint64_t trigger;     // Stream frame of the trigger, sample exact.
+  struct timespec time; // Wall clock when the segment was stored.
+} SegmentStamp;
+
+/**
+ * Segmented acquisition memory: count equal segments, each one filled with
+ * the window around one trigger and stamped, in trigger order, until all are
+ * full. Only the triggered windows are kept, not the dead time between them.
+ */
+typedef struct {
+  size_t count;    // Number of segments.
+  size_t frames;   // Frames per segment.
+  size_t channels;
+  size_t filled;   // Segments stored since armed.
+  float *samples;  // count * frames * channels values.
+  SegmentStamp *stamps;
+  pthread_mutex_t mutex;
+} Segments;
+
+/* ============================================ Public functions declaration */
+
+/**
+ * @brief Creates a new, unarmed, segmented memory. Allocates memory that must
+ * be freed with Segments_destroy.
+ *
+ * @param[in] channels: Number of interleaved channels.
+ * @return Segments instance, NULL if memory allocation errors.
+ */
+Segments *Segments_create(size_t const channels);
+
+/**
+ * @brief Destroys instance. Frees all allocated memory during creation.
+ *
+ * @param[in] self: Segments instance.
+ */
+void Segments_destroy(Segments *self);
+
+/**
+ * @brief Empties every segment and sets their geometry, reallocating the
+ * storage when it changes.
+ *
+ * @param[in] self: Segments instance.
+ * @param[in] count: Number of segments, in [1, SEGMENTS_MAX_COUNT].
+ * @param[in] frames: Frames per segment.
+ * @return false if the storage exceeds SEGMENTS_MAX_SAMPLES or memory
+ * allocation errors, the memory is then unarmed.
+ */
+bool Segments_arm(Segments *const self, size_t const count,
+                  size_t const frames);
+
+/**
+ * @brief Stores a triggered window into the next free segment.
+ *
+ * @param[in] self: Segments instance.
+ * @param[in] src: Window, interleaved samples, frames * channels values.
+ * @param[in] frames: Number of frames in src, must match the armed geometry.
+ * @param[in] trigger: Stream frame of the trigger.
+ * @return Number of free segments left after this one, 0 when full. Windows
+ * given to a full or mismatching memory are dropped.
+ */
+size_t Segments_store(Segments *const self, float const *const src,
+                      size_t const frames, uint64_t const trigger);
+
+/**
+ * @brief Returns the number of segments stored since armed.
+ *
+ * @param[in] self: Segments instance.
+ */
+size_t Segments_filled(Segments *const self);
+
+/**
+ * @brief Copies a stored segment.
+ *
+ * @param[in] self: Segments instance.
+ * @param[in] index: Segment, in trigger order.
+ * @param[out] dst: Segment samples, frames * channels values, may be NULL.
+ * @param[out] stamp: Segment stamp, may be NULL.
+ * @return false if the segment is not stored.
+ */
+bool Segments_read(Segments *const self, size_t const index, float *const dst,
+                   SegmentStamp *const stamp);
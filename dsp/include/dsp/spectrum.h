@@ -0,0 +1,151 @@
+
+#pragma once
+
+#include "dsp/fft.h"
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define SPECTRUM_MIN_SIZE 256
+#define SPECTRUM_MAX_SIZE (1024 * 1024)
+
+typedef enum {
+  SPECTRUM_WINDOW_HANN,
+  SPECTRUM_WINDOW_BLACKMAN_HARRIS, // 4 term, -92 dB side lobes.
+  SPECTRUM_WINDOW_FLAT_TOP         // Accurate amplitudes, wide main lobe.
+} SpectrumWindow;
+
+typedef enum {
+  SPECTRUM_AVERAGE_NONE,      // Latest spectrum only.
+  SPECTRUM_AVERAGE_LINEAR,    // Power mean of the first averages spectra,
+                              // then exponential with weight 1 / averages.
+  SPECTRUM_AVERAGE_PEAK_HOLD, // Per bin maximum, decaying over averages.
+  SPECTRUM_AVERAGE_MAX        // Per bin maximum since the last reset.
+} SpectrumAverage;
+
+/**
+ * Spectrum analyzer over consecutive blocks of the stream. Each block of
+ * size frames is windowed and transformed: a real FFT of the first channel,
+ * or for complex streams a complex FFT of the first two channels with the
+ * negative frequencies first. Bin powers are averaged as configured.
+ *
+ * Configuration is only recorded by Spectrum_configure, the thread calling
+ * Spectrum_process rebuilds plans and windows when it changes, so that FFTs
+ * never run with the mutex held.
+ */
+typedef struct {
+  bool complex;
+  // Requested configuration.
+  size_t requestedSize;
+  SpectrumWindow requestedWindow;
+  SpectrumAverage requestedAverage;
+  size_t requestedAverages;
+  bool resetRequested;
+  // Processing state, owned by the Spectrum_process thread.
+  size_t size;
+  SpectrumWindow window;
+  FftPlan *plan;
+  RealFftPlan *realPlan;
+  float *coefficients;
+  float normalization;
+  float *block;
+  size_t fill;
+  float *re;
+  float *im;
+  float *latest;
+  // Averaged bin powers, shared under the mutex.
+  SpectrumAverage average;
+  size_t averages;
+  float *power;
+  size_t bins;
+  uint64_t count;
+  pthread_mutex_t mutex;
+} Spectrum;
+
+/* ============================================ Public functions declaration */
+
+/**
+ * @brief Creates a new spectrum analyzer. Allocates memory that must be freed
+ * with Spectrum_destroy.
+ *
+ * @param[in] complex: Transform I/Q pairs of the first two channels instead
+ * of the first channel alone.
+ * @return Spectrum instance, NULL if memory allocation errors.
+ */
+Spectrum *Spectrum_create(bool const complex);
+
+/**
+ * @brief Destroys instance. Frees all allocated memory during creation.
+ *
+ * @param[in] self: Spectrum instance.
+ */
+void Spectrum_destroy(Spectrum *self);
+
+/**
+ * @brief Requests a configuration, applied before the next block. Changing
+ * anything restarts the averaging.
+ *
+ * @param[in] self: Spectrum instance.
+ * @param[in] size: FFT size, a power of two in [SPECTRUM_MIN_SIZE,
+ * SPECTRUM_MAX_SIZE].
+ * @param[in] window: Window applied to each block.
+ * @param[in] average: Averaging mode.
+ * @param[in] averages: Number of spectra averaged, or peak hold time
+ * constant in spectra.
+ * @return false if size is invalid.
+ */
+bool Spectrum_configure(Spectrum *const self, size_t const size,
+                        SpectrumWindow const window,
+                        SpectrumAverage const average, size_t const averages);
+
+/**
+ * @brief Restarts the averaging.
+ *
+ * @param[in] self: Spectrum instance.
+ */
+void Spectrum_reset(Spectrum *const self);
+
+/**
+ * @brief Feeds consecutive frames, stopping right after the first block they
+ * complete so that the caller can pick up that spectrum. Frames of an
+ * incomplete block are kept for the next call.
+ *
+ * @param[in] self: Spectrum instance.
+ * @param[in] src: Interleaved samples, frames * channels values.
+ * @param[in] frames: Number of frames in src.
+ * @param[in] channels: Number of interleaved channels, at least 2 for
+ * complex spectra.
+ * @param[out] consumed: Number of frames consumed, all of them when no block
+ * completes.
+ * @param[out] transformed: Set when a block was transformed.
+ * @return false if applying a configuration fails to allocate, the frames
+ * are then dropped.
+ */
+bool Spectrum_process(Spectrum *const self, float const *const src,
+                      size_t const frames, size_t const channels,
+                      size_t *const consumed, bool *const transformed);
+
+/**
+ * @brief Reduces the averaged spectrum to columns, keeping the highest bin
+ * of each, in dB relative to a full scale (amplitude 1) tone.
+ *
+ * @param[in] self: Spectrum instance.
+ * @param[in] columns: Number of output columns.
+ * @param[out] outDb: Column levels, columns values.
+ * @return Number of spectra since the last reset, 0 if none (outDb is then
+ * untouched).
+ */
+uint64_t Spectrum_read(Spectrum *const self, size_t const columns,
+                       float *const outDb);
+
+/**
+ * @brief Same as Spectrum_read on the latest spectrum, before averaging.
+ * Must be called from the thread calling Spectrum_process.
+ *
+ * @param[in] self: Spectrum instance.
+ * @param[in] columns: Number of output columns.
+ * @param[out] outDb: Column levels, columns values.
+ */
+void Spectrum_readLatest(Spectrum *const self, size_t const columns,
+                         float *const outDb);
@@ -0,0 +1,173 @@
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef enum {
+  TRIGGER_SLOPE_RISING,
+  TRIGGER_SLOPE_FALLING,
+  TRIGGER_SLOPE_EITHER
+} TriggerSlope;
+
+typedef enum {
+  TRIGGER_MODE_AUTO,   // Free-runs when no trigger comes for a while.
+  TRIGGER_MODE_NORMAL, // Only triggered acquisitions are shown.
+  TRIGGER_MODE_SINGLE  // Stops after the first triggered acquisition.
+} TriggerMode;
+
+typedef enum {
+  TRIGGER_TYPE_EDGE,
+  TRIGGER_TYPE_PULSE_WIDTH, // Pulse between level crossings, by its width.
+  TRIGGER_TYPE_RUNT,        // Pulse crossing one threshold but not the other.
+  TRIGGER_TYPE_WINDOW,      // Signal entering or leaving [low, high].
+  TRIGGER_TYPE_SLEW,        // Edge from low to high, by its transition time.
+  TRIGGER_TYPE_PATTERN      // Logic pattern across channels becoming true.
+} TriggerType;
+
+typedef enum {
+  TRIGGER_WIDTH_LESS,    // width < widthMax.
+  TRIGGER_WIDTH_GREATER, // width > widthMin.
+  TRIGGER_WIDTH_RANGE    // widthMin <= width <= widthMax.
+} TriggerWidthCondition;
+
+typedef enum { TRIGGER_WINDOW_ENTER, TRIGGER_WINDOW_EXIT } TriggerWindowCondition;
+
+typedef enum {
+  TRIGGER_REGION_UNKNOWN,
+  TRIGGER_REGION_LOW,  // v < low.
+  TRIGGER_REGION_MID,  // low <= v <= high.
+  TRIGGER_REGION_HIGH  // v > high.
+} TriggerRegion;
+
+typedef enum {
+  EDGE_TRIGGER_DISARMED,
+  EDGE_TRIGGER_ARMED_RISING, // Was below level - hysteresis.
+  EDGE_TRIGGER_ARMED_FALLING // Was above level + hysteresis.
+} EdgeTriggerState;
+
+/**
+ * Edge trigger state machine. A rising edge fires when the signal reaches
+ * level after having been below level - hysteresis, a falling edge when it
+ * reaches level after having been above level + hysteresis. Configuration
+ * fields can be changed between scans.
+ */
+typedef struct {
+  TriggerSlope slope;
+  float level;
+  float hysteresis;
+  uint64_t holdoff; // Frames after a trigger during which none can fire.
+  size_t channel;   // Channel of the interleaved frames to trigger on.
+  EdgeTriggerState state;
+  uint64_t nextAllowed;
+} EdgeTrigger;
+
+/**
+ * Trigger of any TriggerType. All types but EDGE and PATTERN follow which of
+ * the regions below low, between low and high, and above high the signal is
+ * in, and decide on region changes. Pulse width uses level -/+ hysteresis as
+ * low and high. The slope selects the pulse polarity (RISING for positive
+ * pulses and runts) and the slew direction. Pattern thresholds every channel
+ * at level and compares the bits selected by patternCare with patternValue
+ * (bit n is channel n). Widths and times are in frames.
+ */
+typedef struct {
+  TriggerType type;
+  TriggerSlope slope;
+  float level;
+  float hysteresis;
+  float low;
+  float high;
+  TriggerWidthCondition widthCondition;
+  uint64_t widthMin;
+  uint64_t widthMax;
+  TriggerWindowCondition windowCondition;
+  uint8_t patternCare;
+  uint8_t patternValue;
+  uint64_t holdoff;
+  size_t channel;
+  EdgeTrigger edge;
+  TriggerRegion region;
+  TriggerRegion midFrom; // Region the signal came from into MID.
+  uint64_t midAt;
+  TriggerRegion extreme; // Last LOW or HIGH region visited.
+  uint64_t extremeAt;
+  bool patternMatched;
+  uint64_t nextFrame;
+  uint64_t nextAllowed;
+} Trigger;
+
+/* ============================================ Public functions declaration */
+
+/**
+ * @brief Initializes a disarmed trigger.
+ *
+ * @param[out] self: EdgeTrigger instance.
+ * @param[in] slope: Edge to trigger on.
+ * @param[in] level: Trigger level.
+ * @param[in] hysteresis: Distance from level the signal must go to re-arm.
+ * @param[in] holdoff: Minimum distance in frames between two triggers.
+ */
+void EdgeTrigger_init(EdgeTrigger *const self, TriggerSlope const slope,
+                      float const level, float const hysteresis,
+                      uint64_t const holdoff);
+
+/**
+ * @brief Disarms the trigger and clears the holdoff.
+ *
+ * @param[in] self: EdgeTrigger instance.
+ */
+void EdgeTrigger_reset(EdgeTrigger *const self);
+
+/**
+ * @brief Finds the first trigger in a block of frames, skipping frames still
+ * in holdoff. The arm state carries over between consecutive blocks, and
+ * scanning can resume in the same block after a trigger. The searches for
+ * the next arming or firing sample are vectorized.
+ *
+ * @param[in] self: EdgeTrigger instance.
+ * @param[in] src: Interleaved samples, frames * channels values.
+ * @param[in] frames: Number of frames in src.
+ * @param[in] channels: Number of interleaved channels.
+ * @param[in] firstFrame: Absolute index of the first frame of src.
+ * @param[out] trigger: Absolute index of the frame that fired.
+ * @return true if a trigger fired in the block.
+ */
+bool EdgeTrigger_next(EdgeTrigger *const self, float const *const src,
+                      size_t const frames, size_t const channels,
+                      uint64_t const firstFrame, uint64_t *const trigger);
+
+/**
+ * @brief Initializes an edge trigger at level 0 with no holdoff. Set the
+ * other fields of the instance to configure it.
+ *
+ * @param[out] self: Trigger instance.
+ */
+void Trigger_init(Trigger *const self);
+
+/**
+ * @brief Forgets the signal history and clears the holdoff.
+ *
+ * @param[in] self: Trigger instance.
+ */
+void Trigger_reset(Trigger *const self);
+
+/**
+ * @brief Same as EdgeTrigger_next for any trigger type. Blocks must be passed
+ * in order. If frames are skipped between two calls, the state machines
+ * resynchronize on the new data and no trigger fires on the gap. Frames
+ * closer than holdoff to the previous trigger are still tracked but cannot
+ * fire.
+ *
+ * @param[in] self: Trigger instance.
+ * @param[in] src: Interleaved samples, frames * channels values.
+ * @param[in] frames: Number of frames in src.
+ * @param[in] channels: Number of interleaved channels.
+ * @param[in] firstFrame: Absolute index of the first frame of src.
+ * @param[out] trigger: Absolute index of the frame that fired.
+ * @return true if a trigger fired in the block.
+ */
+bool Trigger_next(Trigger *const self, float const *const src,
+                  size_t const frames, size_t const channels,
+                  uint64_t const firstFrame, uint64_t *const trigger);
@@ -0,0 +1,77 @@
+
+#pragma once
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define WATERFALL_PALETTE_SIZE 256
+
+/**
+ * Spectrogram history: a ring of RGBA8 rows, one per spectrum. Rows are
+ * written from the bottom of the image up, so that reading the ring from
+ * the newest row down to the bottom and wrapping around to the top shows
+ * the newest spectrum first without moving any pixel. Consumers upload
+ * each new row on its own and scroll by drawing the image in two parts.
+ */
+typedef struct {
+  size_t width;
+  size_t rows;
+  uint8_t *pixels; // rows * width * 4 bytes, row 0 at the top.
+  int32_t *indices;
+  uint64_t written;
+  uint8_t palette[WATERFALL_PALETTE_SIZE][4];
+  pthread_mutex_t mutex;
+} Waterfall;
+
+/* ============================================ Public functions declaration */
+
+/**
+ * @brief Creates a new waterfall. Allocates memory that must be freed with
+ * Waterfall_destroy.
+ *
+ * @param[in] width: Number of columns (usually screen pixels).
+ * @param[in] rows: Number of spectra kept (usually screen pixels).
+ * @return Waterfall instance, NULL if memory allocation errors.
+ */
+Waterfall *Waterfall_create(size_t const width, size_t const rows);
+
+/**
+ * @brief Destroys instance. Frees all allocated memory during creation.
+ *
+ * @param[in] self: Waterfall instance.
+ */
+void Waterfall_destroy(Waterfall *self);
+
+/**
+ * @brief Blanks the history. Readers see the cleared rows as new ones.
+ *
+ * @param[in] self: Waterfall instance.
+ */
+void Waterfall_clear(Waterfall *const self);
+
+/**
+ * @brief Colors one spectrum into the next row of the ring.
+ *
+ * @param[in] self: Waterfall instance.
+ * @param[in] db: Column levels, width values.
+ * @param[in] dbMin: Level mapped to the first palette entry.
+ * @param[in] dbMax: Level mapped to the last palette entry.
+ */
+void Waterfall_push(Waterfall *const self, float const *const db,
+                    float const dbMin, float const dbMax);
+
+/**
+ * @brief Copies the oldest row a reader has not seen yet. A reader that fell
+ * more than rows behind skips to the oldest row still in the ring.
+ *
+ * @param[in] self: Waterfall instance.
+ * @param[in,out] seen: Number of rows pushed the reader has seen, 0 for a
+ * new reader.
+ * @param[out] rgba: Row pixels, width * 4 bytes.
+ * @param[out] row: Image row the pixels belong to.
+ * @return false if there is no new row.
+ */
+bool Waterfall_fetch(Waterfall *const self, uint64_t *const seen,
+                     uint8_t *const rgba, size_t *const row);
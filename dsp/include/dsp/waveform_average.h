@@ -0,0 +1,92 @@
+
+#pragma once
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#define WAVEFORM_AVERAGE_MAX_COUNT 1024
+// Boxcar history limit, count * samples floats.
+#define WAVEFORM_AVERAGE_MAX_HISTORY (16 * 1024 * 1024)
+
+typedef enum {
+  WAVEFORM_AVERAGE_OFF,
+  WAVEFORM_AVERAGE_EXPONENTIAL, // Weight 1 / count, 1 / n before that.
+  WAVEFORM_AVERAGE_BOXCAR       // Mean of the last count waveforms.
+} WaveformAverageMode;
+
+/**
+ * Sample by sample average of trigger aligned waveforms: uncorrelated noise
+ * shrinks by the square root of the number of waveforms averaged while the
+ * repetitive signal stays. The acquisition thread adds waveforms, the
+ * display reads the current mean.
+ */
+typedef struct {
+  int mode;
+  size_t count;    // Waveforms averaged.
+  size_t samples;  // Samples per waveform, 0 until the first one.
+  size_t acquired; // Waveforms added since the last reset.
+  float *mean;     // samples values.
+  double *sum;     // Boxcar running sum, samples values.
+  float *history;  // Boxcar ring of count waveforms.
+  size_t next;     // Boxcar ring slot of the next waveform.
+  pthread_mutex_t mutex;
+} WaveformAverage;
+
+/* ============================================ Public functions declaration */
+
+/**
+ * @brief Creates a new average, off. Allocates memory that must be freed with
+ * WaveformAverage_destroy.
+ *
+ * @return WaveformAverage instance, NULL if memory allocation errors.
+ */
+WaveformAverage *WaveformAverage_create(void);
+
+/**
+ * @brief Destroys instance. Frees all allocated memory during creation.
+ *
+ * @param[in] self: WaveformAverage instance.
+ */
+void WaveformAverage_destroy(WaveformAverage *self);
+
+/**
+ * @brief Drops every waveform added so far.
+ *
+ * @param[in] self: WaveformAverage instance.
+ */
+void WaveformAverage_reset(WaveformAverage *const self);
+
+/**
+ * @brief Sets mode and count, the average restarts when they change.
+ *
+ * @param[in] self: WaveformAverage instance.
+ * @param[in] mode: One of WaveformAverageMode.
+ * @param[in] count: Number of waveforms, in [1, WAVEFORM_AVERAGE_MAX_COUNT].
+ */
+void WaveformAverage_configure(WaveformAverage *const self, int const mode,
+                               size_t const count);
+
+/**
+ * @brief Adds a waveform. The average restarts when its length changes.
+ *
+ * @param[in] self: WaveformAverage instance.
+ * @param[in] src: Waveform, interleaved samples.
+ * @param[in] samples: Number of values in src.
+ * @return false if off or if memory allocation errors.
+ */
+bool WaveformAverage_add(WaveformAverage *const self, float const *const src,
+                         size_t const samples);
+
+/**
+ * @brief Copies the current mean.
+ *
+ * @param[in] self: WaveformAverage instance.
+ * @param[out] dst: Mean waveform, up to maxSamples values.
+ * @param[in] maxSamples: Size of dst.
+ * @param[out] acquired: Waveforms added since the last reset.
+ * @return Number of values copied, 0 when nothing was averaged yet or the
+ * mean does not fit in dst.
+ */
+size_t WaveformAverage_read(WaveformAverage *const self, float *const dst,
+                            size_t const maxSamples, size_t *const acquired);
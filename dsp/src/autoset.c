@@ -0,0 +1,133 @@
+
+#include "dsp/autoset.h"
+#include <assert.h>
+#include <stdlib.h>
+
+#define dassert(exp) assert(exp)
+
+// Fraction of the peak to peak amplitude, rejects noise around the level.
+#define AUTOSET_HYSTERESIS 0.1f
+
+static void clearBlock(Autoset *const self);
+static void closeBlock(Autoset *const self);
+
+Autoset *Autoset_create(void) {
+  Autoset *self = calloc(1, sizeof(Autoset));
+  if (!self) {
+    return NULL;
+  }
+  clearBlock(self);
+  pthread_mutex_init(&self->mutex, NULL);
+  return self;
+}
+
+void Autoset_destroy(Autoset *self) {
+  if (!self) {
+    return;
+  }
+  pthread_mutex_destroy(&self->mutex);
+  free(self);
+  return;
+}
+
+void Autoset_reset(Autoset *const self) {
+  pthread_mutex_lock(&self->mutex);
+  self->blocks = 0;
+  self->next = 0;
+  self->armed = false;
+  self->hasCrossing = false;
+  clearBlock(self);
+  pthread_mutex_unlock(&self->mutex);
+  return;
+}
+
+void Autoset_process(Autoset *const self, float const *const src,
+                     size_t const frames, size_t const channels) {
+  dassert(channels > 0);
+  pthread_mutex_lock(&self->mutex);
+  for (size_t i = 0; i < frames; i++) {
+    float const x = src[i * channels];
+    self->min = (x < self->min) ? x : self->min;
+    self->max = (x > self->max) ? x : self->max;
+    // Thresholds are only known once a block is complete.
+    if (self->blocks > 0) {
+      float const low = self->level - self->hysteresis;
+      float const high = self->level + self->hysteresis;
+      if (x < low) {
+        self->armed = true;
+      } else if (self->armed && x > high) {
+        // Linear interpolation of the threshold crossing, the constant bias
+        // cancels out in the intervals.
+        double const crossing =
+            self->frame + i - 1 + (high - self->last) / (x - self->last);
+        if (self->hasCrossing) {
+          self->intervals += crossing - self->lastCrossing;
+          self->crossings++;
+        }
+        self->lastCrossing = crossing;
+        self->hasCrossing = true;
+        self->armed = false;
+      }
+    }
+    self->last = x;
+    if (++self->frames == AUTOSET_BLOCK_FRAMES) {
+      closeBlock(self);
+    }
+  }
+  self->frame += frames;
+  pthread_mutex_unlock(&self->mutex);
+  return;
+}
+
+bool Autoset_estimate(Autoset *const self, AutosetEstimate *const estimate) {
+  pthread_mutex_lock(&self->mutex);
+  // The block being filled counts too, so that slow streams get estimates
+  // before the first block completes.
+  bool const valid = self->blocks > 0 || self->frames > 0;
+  float min = self->min;
+  float max = self->max;
+  uint64_t crossings = self->crossings;
+  double intervals = self->intervals;
+  for (size_t b = 0; b < self->blocks; b++) {
+    min = (self->blockMin[b] < min) ? self->blockMin[b] : min;
+    max = (self->blockMax[b] > max) ? self->blockMax[b] : max;
+    crossings += self->blockCrossings[b];
+    intervals += self->blockIntervals[b];
+  }
+  pthread_mutex_unlock(&self->mutex);
+  estimate->min = min;
+  estimate->max = max;
+  estimate->period = (crossings) ? intervals / crossings : 0;
+  return valid;
+}
+
+/* Starts an empty block. */
+static void clearBlock(Autoset *const self) {
+  self->frames = 0;
+  self->min = 1e30f;
+  self->max = -1e30f;
+  self->crossings = 0;
+  self->intervals = 0;
+  return;
+}
+
+/* Moves the block being filled into the ring and updates the crossing
+ * thresholds from the whole ring. */
+static void closeBlock(Autoset *const self) {
+  self->blockMin[self->next] = self->min;
+  self->blockMax[self->next] = self->max;
+  self->blockCrossings[self->next] = self->crossings;
+  self->blockIntervals[self->next] = self->intervals;
+  self->next = (self->next + 1) % AUTOSET_HISTORY;
+  self->blocks += (self->blocks < AUTOSET_HISTORY) ? 1 : 0;
+  float min = self->blockMin[0];
+  float max = self->blockMax[0];
+  for (size_t b = 1; b < self->blocks; b++) {
+    min = (self->blockMin[b] < min) ? self->blockMin[b] : min;
+    max = (self->blockMax[b] > max) ? self->blockMax[b] : max;
+  }
+  self->level = (min + max) / 2;
+  self->hysteresis = (max - min) * AUTOSET_HYSTERESIS;
+  clearBlock(self);
+  return;
+}
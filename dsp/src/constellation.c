@@ -0,0 +1,192 @@
+
+#include "dsp/constellation.h"
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#endif
+
+#define dassert(exp) assert(exp)
+
+#define CONSTELLATION_BLOCK 4096
+#define CONSTELLATION_TIMING_GAIN 0.05
+// Keeps the timing error normalization finite on silent input.
+#define CONSTELLATION_MIN_POWER 1e-12f
+
+static void deinterleave(float const *const src, size_t const frames,
+                         size_t const channels, float *const x,
+                         float *const y);
+static size_t recoverSymbols(Constellation *const self,
+                             float const *const src, size_t const frames,
+                             size_t const channels, float const min,
+                             float const max);
+static void clearTiming(Constellation *const self);
+
+Constellation *Constellation_create(size_t const width, size_t const height,
+                                    double const samplesPerSymbol) {
+  dassert(samplesPerSymbol == 0 || samplesPerSymbol >= 2);
+  Constellation *self = calloc(1, sizeof(Constellation));
+  if (!self) {
+    return NULL;
+  }
+  self->samplesPerSymbol = samplesPerSymbol;
+  self->map = Persistence_create(width, height);
+  self->x = calloc(CONSTELLATION_BLOCK, sizeof(float));
+  self->y = calloc(CONSTELLATION_BLOCK, sizeof(float));
+  if (!self->map || !self->x || !self->y) {
+    Persistence_destroy(self->map);
+    free(self->x);
+    free(self->y);
+    free(self);
+    return NULL;
+  }
+  clearTiming(self);
+  pthread_mutex_init(&self->mutex, NULL);
+  return self;
+}
+
+void Constellation_destroy(Constellation *self) {
+  if (!self) {
+    return;
+  }
+  Persistence_destroy(self->map);
+  free(self->x);
+  free(self->y);
+  pthread_mutex_destroy(&self->mutex);
+  free(self);
+  return;
+}
+
+void Constellation_reset(Constellation *const self) {
+  pthread_mutex_lock(&self->mutex);
+  clearTiming(self);
+  Persistence_clear(self->map);
+  pthread_mutex_unlock(&self->mutex);
+  return;
+}
+
+void Constellation_resync(Constellation *const self) {
+  pthread_mutex_lock(&self->mutex);
+  clearTiming(self);
+  pthread_mutex_unlock(&self->mutex);
+  return;
+}
+
+void Constellation_process(Constellation *const self, float const *const src,
+                           size_t const frames, size_t const channels,
+                           float const min, float const max) {
+  dassert(channels >= 2);
+  pthread_mutex_lock(&self->mutex);
+  if (self->samplesPerSymbol > 0) {
+    size_t done = 0;
+    while (done < frames) {
+      done += recoverSymbols(self, src + done * channels, frames - done,
+                             channels, min, max);
+    }
+  } else {
+    for (size_t first = 0; first < frames; first += CONSTELLATION_BLOCK) {
+      size_t const count = (frames - first < CONSTELLATION_BLOCK)
+                               ? frames - first
+                               : CONSTELLATION_BLOCK;
+      deinterleave(src + first * channels, count, channels, self->x, self->y);
+      Persistence_accumulatePoints(self->map, self->x, self->y, count, min,
+                                   max, min, max);
+    }
+  }
+  pthread_mutex_unlock(&self->mutex);
+  return;
+}
+
+static void deinterleave(float const *const src, size_t const frames,
+                         size_t const channels, float *const x,
+                         float *const y) {
+  size_t i = 0;
+#if defined(__SSE__)
+  if (channels == 2) {
+    for (; i + 4 <= frames; i += 4) {
+      __m128 const a = _mm_loadu_ps(src + 2 * i);
+      __m128 const b = _mm_loadu_ps(src + 2 * i + 4);
+      _mm_storeu_ps(x + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+      _mm_storeu_ps(y + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+    }
+  }
+#endif
+  for (; i < frames; i++) {
+    x[i] = src[i * channels];
+    y[i] = src[i * channels + 1];
+  }
+  return;
+}
+
+/* Runs the timing loop until frames or the point buffer run out, plots the
+ * symbols found and returns the number of frames consumed. */
+static size_t recoverSymbols(Constellation *const self,
+                             float const *const src, size_t const frames,
+                             size_t const channels, float const min,
+                             float const max) {
+  double const sps = self->samplesPerSymbol;
+  size_t count = 0;
+  size_t i = 0;
+  // Frame i sits at time i, events falling in (i - 1, i] interpolate
+  // between the previous frame and frame i.
+  for (; i < frames && count < CONSTELLATION_BLOCK; i++) {
+    float const *const frame = src + i * channels;
+    if (!self->hasLast) {
+      self->last[0] = frame[0];
+      self->last[1] = frame[1];
+      self->hasLast = true;
+      self->nextMid = i + sps / 2;
+      self->nextStrobe = i + sps;
+      continue;
+    }
+    while (self->nextMid <= i || self->nextStrobe <= i) {
+      bool const isStrobe = self->nextStrobe <= self->nextMid;
+      double const at = (isStrobe) ? self->nextStrobe : self->nextMid;
+      float const mu = (float)(at - (i - 1));
+      float const *const last = self->last;
+      float const value[2] = {last[0] + mu * (frame[0] - last[0]),
+                              last[1] + mu * (frame[1] - last[1])};
+      if (!isStrobe) {
+        memcpy(self->mid, value, sizeof(value));
+        self->nextMid = at + sps;
+        continue;
+      }
+      // Gardner: (previous - current) * mid is zero when strobes are on the
+      // symbol centers, negative when late. Normalized by the symbol power.
+      double error = 0;
+      if (self->hasStrobe) {
+        float const power = (self->strobe[0] * self->strobe[0] +
+                             self->strobe[1] * self->strobe[1] +
+                             value[0] * value[0] + value[1] * value[1]) /
+                                2 +
+                            CONSTELLATION_MIN_POWER;
+        error = ((self->strobe[0] - value[0]) * self->mid[0] +
+                 (self->strobe[1] - value[1]) * self->mid[1]) /
+                power;
+        error = (error > 1) ? 1 : (error < -1) ? -1 : error;
+      }
+      memcpy(self->strobe, value, sizeof(value));
+      self->hasStrobe = true;
+      self->x[count] = value[0];
+      self->y[count] = value[1];
+      count++;
+      self->nextStrobe = at + sps + CONSTELLATION_TIMING_GAIN * sps * error;
+      self->nextMid = self->nextStrobe - sps / 2;
+    }
+    self->last[0] = frame[0];
+    self->last[1] = frame[1];
+  }
+  // Times are kept relative to the next chunk.
+  self->nextMid -= i;
+  self->nextStrobe -= i;
+  Persistence_accumulatePoints(self->map, self->x, self->y, count, min, max,
+                               min, max);
+  return i;
+}
+
+static void clearTiming(Constellation *const self) {
+  self->hasLast = false;
+  self->hasStrobe = false;
+  return;
+}
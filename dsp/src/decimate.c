@@ -0,0 +1,212 @@
+
+#include "dsp/decimate.h"
+#include <assert.h>
+#include <math.h>
+#include <stdint.h>
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#endif
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#define dassert(exp) assert(exp)
+
+static void minMaxRange(float const *const src, size_t const count,
+                        size_t const channels, float *const outMin,
+                        float *const outMax);
+static void sumRange(float const *const src, size_t const count,
+                     size_t const channels, double *const outSum,
+                     double *const outSumSquares);
+static void lttbChannel(float const *const src, size_t const frames,
+                        size_t const channels, size_t const columns,
+                        float *const outX, float *const outY);
+
+void Decimate_minMax(float const *const src, size_t const frames,
+                     size_t const channels, size_t const columns,
+                     float *const outMin, float *const outMax) {
+  dassert(channels == 1 || channels == 2 || channels == 4);
+  dassert(frames >= columns);
+  size_t begin = 0;
+  for (size_t c = 0; c < columns; c++) {
+    size_t const end = (size_t)(((uint64_t)(c + 1) * frames) / columns);
+    minMaxRange(&src[begin * channels], (end - begin) * channels, channels,
+                &outMin[c * channels], &outMax[c * channels]);
+    begin = end;
+  }
+  return;
+}
+
+void Decimate_rms(float const *const src, size_t const frames,
+                  size_t const channels, size_t const columns,
+                  float *const outLow, float *const outHigh) {
+  dassert(channels == 1 || channels == 2 || channels == 4);
+  dassert(frames >= columns);
+  size_t begin = 0;
+  for (size_t c = 0; c < columns; c++) {
+    size_t const end = (size_t)(((uint64_t)(c + 1) * frames) / columns);
+    double sum[4], sumSquares[4];
+    sumRange(&src[begin * channels], (end - begin) * channels, channels, sum,
+             sumSquares);
+    double const n = (double)(end - begin);
+    for (size_t ch = 0; ch < channels; ch++) {
+      // In double, the difference does not cancel out under a DC offset.
+      double const mean = sum[ch] / n;
+      double const variance = sumSquares[ch] / n - mean * mean;
+      double const rms = (variance > 0) ? sqrt(variance) : 0;
+      outLow[c * channels + ch] = (float)(mean - rms);
+      outHigh[c * channels + ch] = (float)(mean + rms);
+    }
+    begin = end;
+  }
+  return;
+}
+
+void Decimate_lttb(float const *const src, size_t const frames,
+                   size_t const channels, size_t const columns,
+                   float *const outX, float *const outY) {
+  dassert(channels == 1 || channels == 2 || channels == 4);
+  dassert(frames >= columns && columns >= 3);
+  for (size_t ch = 0; ch < channels; ch++) {
+    lttbChannel(&src[ch], frames, channels, columns, &outX[ch], &outY[ch]);
+  }
+  return;
+}
+
+/*
+ * count values starting at a frame boundary. Since channels divides the
+ * vector width, lane j always sees channel j % channels and the lanes are
+ * only folded together once per range.
+ */
+static void minMaxRange(float const *const src, size_t const count,
+                        size_t const channels, float *const outMin,
+                        float *const outMax) {
+  float laneMin[4] = {src[0 % count], src[1 % count], src[2 % count],
+                      src[3 % count]};
+  float laneMax[4] = {laneMin[0], laneMin[1], laneMin[2], laneMin[3]};
+  size_t i = 0;
+#if defined(__SSE__)
+  if (count >= 4) {
+    __m128 vMin = _mm_loadu_ps(src);
+    __m128 vMax = vMin;
+    for (i = 4; i + 16 <= count; i += 16) {
+      __m128 a = _mm_loadu_ps(&src[i]);
+      __m128 b = _mm_loadu_ps(&src[i + 4]);
+      __m128 c = _mm_loadu_ps(&src[i + 8]);
+      __m128 d = _mm_loadu_ps(&src[i + 12]);
+      vMin = _mm_min_ps(vMin, _mm_min_ps(_mm_min_ps(a, b), _mm_min_ps(c, d)));
+      vMax = _mm_max_ps(vMax, _mm_max_ps(_mm_max_ps(a, b), _mm_max_ps(c, d)));
+    }
+    for (; i + 4 <= count; i += 4) {
+      __m128 a = _mm_loadu_ps(&src[i]);
+      vMin = _mm_min_ps(vMin, a);
+      vMax = _mm_max_ps(vMax, a);
+    }
+    _mm_storeu_ps(laneMin, vMin);
+    _mm_storeu_ps(laneMax, vMax);
+  }
+#endif
+  for (; i < count; i++) {
+    float const v = src[i];
+    size_t const lane = i & 3;
+    laneMin[lane] = (v < laneMin[lane]) ? v : laneMin[lane];
+    laneMax[lane] = (v > laneMax[lane]) ? v : laneMax[lane];
+  }
+  for (size_t ch = 0; ch < channels; ch++) {
+    float mn = laneMin[ch];
+    float mx = laneMax[ch];
+    for (size_t lane = ch + channels; lane < 4; lane += channels) {
+      mn = (laneMin[lane] < mn) ? laneMin[lane] : mn;
+      mx = (laneMax[lane] > mx) ? laneMax[lane] : mx;
+    }
+    outMin[ch] = mn;
+    outMax[ch] = mx;
+  }
+  return;
+}
+
+/* Same lane layout as minMaxRange, accumulated in double. */
+static void sumRange(float const *const src, size_t const count,
+                     size_t const channels, double *const outSum,
+                     double *const outSumSquares) {
+  double laneSum[4] = {0, 0, 0, 0};
+  double laneSumSquares[4] = {0, 0, 0, 0};
+  size_t i = 0;
+#if defined(__SSE2__)
+  // Lanes 0-1 and 2-3 of each vector of floats.
+  __m128d sumLo = _mm_setzero_pd();
+  __m128d sumHi = _mm_setzero_pd();
+  __m128d squaresLo = _mm_setzero_pd();
+  __m128d squaresHi = _mm_setzero_pd();
+  for (; i + 4 <= count; i += 4) {
+    __m128 const a = _mm_loadu_ps(&src[i]);
+    __m128d const lo = _mm_cvtps_pd(a);
+    __m128d const hi = _mm_cvtps_pd(_mm_movehl_ps(a, a));
+    sumLo = _mm_add_pd(sumLo, lo);
+    sumHi = _mm_add_pd(sumHi, hi);
+    squaresLo = _mm_add_pd(squaresLo, _mm_mul_pd(lo, lo));
+    squaresHi = _mm_add_pd(squaresHi, _mm_mul_pd(hi, hi));
+  }
+  _mm_storeu_pd(&laneSum[0], sumLo);
+  _mm_storeu_pd(&laneSum[2], sumHi);
+  _mm_storeu_pd(&laneSumSquares[0], squaresLo);
+  _mm_storeu_pd(&laneSumSquares[2], squaresHi);
+#endif
+  for (; i < count; i++) {
+    laneSum[i & 3] += src[i];
+    laneSumSquares[i & 3] += (double)src[i] * src[i];
+  }
+  for (size_t ch = 0; ch < channels; ch++) {
+    outSum[ch] = 0;
+    outSumSquares[ch] = 0;
+    for (size_t lane = ch; lane < 4; lane += channels) {
+      outSum[ch] += laneSum[lane];
+      outSumSquares[ch] += laneSumSquares[lane];
+    }
+  }
+  return;
+}
+
+/* src, outX and outY are strided by channels. */
+static void lttbChannel(float const *const src, size_t const frames,
+                        size_t const channels, size_t const columns,
+                        float *const outX, float *const outY) {
+  double const bucketSize = (double)(frames - 2) / (columns - 2);
+  size_t selected = 0;
+  outX[0] = 0;
+  outY[0] = src[0];
+  for (size_t b = 0; b < columns - 2; b++) {
+    size_t const begin = (size_t)(b * bucketSize) + 1;
+    size_t const end = (size_t)((b + 1) * bucketSize) + 1;
+    // Average point of the next bucket, the last frame for the last bucket.
+    size_t const nextBegin = end;
+    size_t nextEnd = (size_t)((b + 2) * bucketSize) + 1;
+    nextEnd = (nextEnd < frames) ? nextEnd : frames;
+    // Frame indices are not exact in float past 2^24, x stays in double.
+    double const avgX = (nextBegin + nextEnd - 1) / 2.0;
+    double avgY = 0;
+    for (size_t i = nextBegin; i < nextEnd; i++) {
+      avgY += src[i * channels];
+    }
+    avgY /= (nextEnd - nextBegin);
+    double const ax = (double)selected;
+    double const ay = src[selected * channels];
+    double maxArea = -1;
+    size_t best = begin;
+    for (size_t i = begin; i < end; i++) {
+      // Twice the triangle area, the factor does not change the argmax.
+      double const area = fabs((ax - avgX) * (src[i * channels] - ay) -
+                               (ax - (double)i) * (avgY - ay));
+      if (area > maxArea) {
+        maxArea = area;
+        best = i;
+      }
+    }
+    selected = best;
+    outX[(b + 1) * channels] = selected;
+    outY[(b + 1) * channels] = src[selected * channels];
+  }
+  outX[(columns - 1) * channels] = frames - 1;
+  outY[(columns - 1) * channels] = src[(frames - 1) * channels];
+  return;
+}
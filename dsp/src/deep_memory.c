@@ -0,0 +1,298 @@
+
+#include "dsp/deep_memory.h"
+#include "dsp/decimate.h"
+#include <assert.h>
+#include <float.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define dassert(exp) assert(exp)
+
+static bool isStored(DeepMemory const *const self, uint64_t const first,
+                     size_t const frameCount);
+static void completeBlocks(DeepMemory *const self, uint64_t const oldTotal);
+static void mergeEntries(float const *const srcMin, float const *const srcMax,
+                         size_t const count, size_t const channels,
+                         float *const outMin, float *const outMax);
+static void rangeMinMax(DeepMemory const *const self, uint64_t a,
+                        uint64_t const b, float *const outMin,
+                        float *const outMax);
+static void consumeUnits(DeepMemory const *const self, int const level,
+                         uint64_t *const a, uint64_t const end,
+                         float *const outMin, float *const outMax);
+
+DeepMemory *DeepMemory_create(size_t const sizeBytes, size_t const channels) {
+  dassert(channels == 1 || channels == 2 || channels == 4);
+  DeepMemory *self = calloc(1, sizeof(DeepMemory));
+  if (!self) {
+    return NULL;
+  }
+  size_t const maxFrames = sizeBytes / (channels * sizeof(float));
+  // Add levels while the top one still has a useful number of entries.
+  self->blockFrames[0] = DEEP_MEMORY_BASE_BLOCK;
+  self->levels = 1;
+  while (self->levels < DEEP_MEMORY_MAX_LEVELS &&
+         maxFrames / (self->blockFrames[self->levels - 1] *
+                      DEEP_MEMORY_LEVEL_FACTOR) >=
+             DEEP_MEMORY_BASE_BLOCK) {
+    self->blockFrames[self->levels] =
+        self->blockFrames[self->levels - 1] * DEEP_MEMORY_LEVEL_FACTOR;
+    self->levels++;
+  }
+  size_t const topBlock = self->blockFrames[self->levels - 1];
+  self->capacity = (maxFrames / topBlock) * topBlock;
+  self->channels = channels;
+  if (self->capacity == 0) {
+    free(self);
+    return NULL;
+  }
+  self->samples = calloc(self->capacity * channels, sizeof(float));
+  bool ok = self->samples != NULL;
+  for (size_t l = 0; l < self->levels && ok; l++) {
+    size_t const entries = self->capacity / self->blockFrames[l] * channels;
+    self->levelMin[l] = calloc(entries, sizeof(float));
+    self->levelMax[l] = calloc(entries, sizeof(float));
+    ok = self->levelMin[l] && self->levelMax[l];
+  }
+  if (!ok) {
+    DeepMemory_destroy(self);
+    return NULL;
+  }
+  pthread_mutex_init(&self->mutex, NULL);
+  // Timed waits must not jump with the wall clock.
+  pthread_condattr_t attr;
+  pthread_condattr_init(&attr);
+  pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+  pthread_cond_init(&self->written, &attr);
+  pthread_condattr_destroy(&attr);
+  return self;
+}
+
+void DeepMemory_destroy(DeepMemory *self) {
+  if (!self) {
+    return;
+  }
+  for (size_t l = 0; l < self->levels; l++) {
+    free(self->levelMin[l]);
+    free(self->levelMax[l]);
+  }
+  free(self->samples);
+  pthread_mutex_destroy(&self->mutex);
+  pthread_cond_destroy(&self->written);
+  free(self);
+  return;
+}
+
+void DeepMemory_reset(DeepMemory *const self) {
+  pthread_mutex_lock(&self->mutex);
+  self->total = 0;
+  pthread_mutex_unlock(&self->mutex);
+  return;
+}
+
+void DeepMemory_write(DeepMemory *const self, float const *const frames,
+                      size_t const frameCount) {
+  size_t const ch = self->channels;
+  // Only the newest capacity frames of a huge write can survive.
+  size_t const skip =
+      (frameCount > self->capacity) ? frameCount - self->capacity : 0;
+  pthread_mutex_lock(&self->mutex);
+  uint64_t const oldTotal = self->total + skip;
+  size_t const pos = oldTotal % self->capacity;
+  size_t const count = frameCount - skip;
+  size_t const first = (count <= self->capacity - pos) ? count
+                                                       : self->capacity - pos;
+  memcpy(&self->samples[pos * ch], &frames[skip * ch],
+         first * ch * sizeof(float));
+  memcpy(self->samples, &frames[(skip + first) * ch],
+         (count - first) * ch * sizeof(float));
+  self->total = oldTotal + count;
+  completeBlocks(self, oldTotal);
+  pthread_cond_broadcast(&self->written);
+  pthread_mutex_unlock(&self->mutex);
+  return;
+}
+
+uint64_t DeepMemory_range(DeepMemory *const self, uint64_t *const oldest) {
+  pthread_mutex_lock(&self->mutex);
+  uint64_t const total = self->total;
+  pthread_mutex_unlock(&self->mutex);
+  *oldest = (total > self->capacity) ? total - self->capacity : 0;
+  return total;
+}
+
+uint64_t DeepMemory_wait(DeepMemory *const self, uint64_t const newest,
+                         long const timeoutNs) {
+  struct timespec deadline;
+  clock_gettime(CLOCK_MONOTONIC, &deadline);
+  deadline.tv_nsec += timeoutNs;
+  deadline.tv_sec += deadline.tv_nsec / 1000000000L;
+  deadline.tv_nsec %= 1000000000L;
+  pthread_mutex_lock(&self->mutex);
+  int err = 0;
+  while (self->total == newest && err == 0) {
+    err = pthread_cond_timedwait(&self->written, &self->mutex, &deadline);
+  }
+  uint64_t const total = self->total;
+  pthread_mutex_unlock(&self->mutex);
+  return total;
+}
+
+bool DeepMemory_copy(DeepMemory *const self, uint64_t const first,
+                     size_t const frameCount, float *const dst) {
+  dassert(frameCount <= self->capacity);
+  size_t const ch = self->channels;
+  pthread_mutex_lock(&self->mutex);
+  if (!isStored(self, first, frameCount)) {
+    pthread_mutex_unlock(&self->mutex);
+    return false;
+  }
+  size_t const pos = first % self->capacity;
+  size_t const head = (frameCount <= self->capacity - pos)
+                          ? frameCount
+                          : self->capacity - pos;
+  memcpy(dst, &self->samples[pos * ch], head * ch * sizeof(float));
+  memcpy(&dst[head * ch], self->samples,
+         (frameCount - head) * ch * sizeof(float));
+  pthread_mutex_unlock(&self->mutex);
+  return true;
+}
+
+bool DeepMemory_reduce(DeepMemory *const self, uint64_t const first,
+                       size_t const frameCount, size_t const columns,
+                       float *const outMin, float *const outMax) {
+  dassert(frameCount >= columns && frameCount <= self->capacity);
+  size_t const ch = self->channels;
+  pthread_mutex_lock(&self->mutex);
+  if (!isStored(self, first, frameCount)) {
+    pthread_mutex_unlock(&self->mutex);
+    return false;
+  }
+  uint64_t begin = first;
+  for (size_t c = 0; c < columns; c++) {
+    // (c + 1) * frameCount / columns, split so that it cannot overflow.
+    uint64_t const end = first + (uint64_t)(frameCount / columns) * (c + 1) +
+                         (uint64_t)(frameCount % columns) * (c + 1) / columns;
+    for (size_t k = 0; k < ch; k++) {
+      outMin[c * ch + k] = FLT_MAX;
+      outMax[c * ch + k] = -FLT_MAX;
+    }
+    rangeMinMax(self, begin, end, &outMin[c * ch], &outMax[c * ch]);
+    begin = end;
+  }
+  pthread_mutex_unlock(&self->mutex);
+  return true;
+}
+
+/* Whether [first, first + frameCount) is stored, called with the lock held. */
+static bool isStored(DeepMemory const *const self, uint64_t const first,
+                     size_t const frameCount) {
+  uint64_t const total = self->total;
+  uint64_t const oldest = (total > self->capacity) ? total - self->capacity : 0;
+  return first >= oldest && first <= total && frameCount <= total - first;
+}
+
+/* Fills the pyramid entries of every block completed since oldTotal. */
+static void completeBlocks(DeepMemory *const self, uint64_t const oldTotal) {
+  size_t const ch = self->channels;
+  for (size_t l = 0; l < self->levels; l++) {
+    uint64_t const size = self->blockFrames[l];
+    size_t const slots = self->capacity / size;
+    uint64_t block = oldTotal / size;
+    // Blocks that are older than the memory can be skipped.
+    uint64_t const lastBlock = self->total / size;
+    if (lastBlock > slots && block < lastBlock - slots) {
+      block = lastBlock - slots;
+    }
+    for (; block < lastBlock; block++) {
+      size_t const slot = block % slots;
+      if (l == 0) {
+        Decimate_minMax(&self->samples[slot * size * ch], size, ch, 1,
+                        &self->levelMin[0][slot * ch],
+                        &self->levelMax[0][slot * ch]);
+      } else {
+        size_t const below = slot * DEEP_MEMORY_LEVEL_FACTOR;
+        mergeEntries(&self->levelMin[l - 1][below * ch],
+                     &self->levelMax[l - 1][below * ch],
+                     DEEP_MEMORY_LEVEL_FACTOR, ch,
+                     &self->levelMin[l][slot * ch],
+                     &self->levelMax[l][slot * ch]);
+      }
+    }
+  }
+  return;
+}
+
+static void mergeEntries(float const *const srcMin, float const *const srcMax,
+                         size_t const count, size_t const channels,
+                         float *const outMin, float *const outMax) {
+  for (size_t k = 0; k < channels; k++) {
+    float mn = srcMin[k];
+    float mx = srcMax[k];
+    for (size_t i = 1; i < count; i++) {
+      float const a = srcMin[i * channels + k];
+      float const b = srcMax[i * channels + k];
+      mn = (a < mn) ? a : mn;
+      mx = (b > mx) ? b : mx;
+    }
+    outMin[k] = mn;
+    outMax[k] = mx;
+  }
+  return;
+}
+
+/*
+ * Segment-tree style walk over [a, b): climb levels while a whole block of
+ * the next level fits, then walk back down for the tail. At most
+ * DEEP_MEMORY_LEVEL_FACTOR entries per level and side are visited, and fewer
+ * than DEEP_MEMORY_BASE_BLOCK raw frames per side.
+ */
+static void rangeMinMax(DeepMemory const *const self, uint64_t a,
+                        uint64_t const b, float *const outMin,
+                        float *const outMax) {
+  int level = -1;
+  while (level + 1 < (int)self->levels) {
+    uint64_t const next = self->blockFrames[level + 1];
+    uint64_t const aligned = (a + next - 1) / next * next;
+    if (aligned + next > b) {
+      break;
+    }
+    consumeUnits(self, level, &a, aligned, outMin, outMax);
+    level++;
+  }
+  for (; level >= -1; level--) {
+    consumeUnits(self, level, &a, b, outMin, outMax);
+  }
+  return;
+}
+
+/* Folds the whole units (raw frames for level -1) of level in [*a, end). */
+static void consumeUnits(DeepMemory const *const self, int const level,
+                         uint64_t *const a, uint64_t const end,
+                         float *const outMin, float *const outMax) {
+  size_t const ch = self->channels;
+  if (level < 0) {
+    for (; *a < end; (*a)++) {
+      float const *const frame = &self->samples[(*a % self->capacity) * ch];
+      for (size_t k = 0; k < ch; k++) {
+        outMin[k] = (frame[k] < outMin[k]) ? frame[k] : outMin[k];
+        outMax[k] = (frame[k] > outMax[k]) ? frame[k] : outMax[k];
+      }
+    }
+    return;
+  }
+  uint64_t const size = self->blockFrames[level];
+  size_t const slots = self->capacity / size;
+  for (; *a + size <= end; *a += size) {
+    size_t const slot = (*a / size) % slots;
+    for (size_t k = 0; k < ch; k++) {
+      float const mn = self->levelMin[level][slot * ch + k];
+      float const mx = self->levelMax[level][slot * ch + k];
+      outMin[k] = (mn < outMin[k]) ? mn : outMin[k];
+      outMax[k] = (mx > outMax[k]) ? mx : outMax[k];
+    }
+  }
+  return;
+}
@@ -0,0 +1,123 @@
+
+#include "dsp/envelope.h"
+#include "dsp/decimate.h"
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#endif
+
+#define dassert(exp) assert(exp)
+
+static bool allocate(Envelope *const self, size_t const frames);
+
+Envelope *Envelope_create(size_t const columns, size_t const channels) {
+  dassert(columns > 0);
+  dassert(channels == 1 || channels == 2 || channels == 4);
+  Envelope *self = calloc(1, sizeof(Envelope));
+  if (!self) {
+    return NULL;
+  }
+  self->columns = columns;
+  self->channels = channels;
+  self->scratch = calloc(columns * channels, sizeof(float));
+  if (!self->scratch) {
+    free(self);
+    return NULL;
+  }
+  pthread_mutex_init(&self->mutex, NULL);
+  return self;
+}
+
+void Envelope_destroy(Envelope *self) {
+  if (!self) {
+    return;
+  }
+  free(self->min);
+  free(self->max);
+  free(self->scratch);
+  pthread_mutex_destroy(&self->mutex);
+  free(self);
+  return;
+}
+
+void Envelope_reset(Envelope *const self) {
+  pthread_mutex_lock(&self->mutex);
+  self->acquired = 0;
+  pthread_mutex_unlock(&self->mutex);
+  return;
+}
+
+bool Envelope_add(Envelope *const self, float const *const src,
+                  size_t const frames) {
+  dassert(frames > 0);
+  pthread_mutex_lock(&self->mutex);
+  bool const ready = frames == self->frames || allocate(self, frames);
+  size_t const samples = frames * self->channels;
+  if (ready && self->acquired == 0) {
+    memcpy(self->min, src, samples * sizeof(float));
+    memcpy(self->max, src, samples * sizeof(float));
+  } else if (ready) {
+    float *const min = self->min;
+    float *const max = self->max;
+    size_t i = 0;
+#if defined(__SSE__)
+    for (; i + 4 <= samples; i += 4) {
+      __m128 const x = _mm_loadu_ps(&src[i]);
+      _mm_storeu_ps(&min[i], _mm_min_ps(_mm_loadu_ps(&min[i]), x));
+      _mm_storeu_ps(&max[i], _mm_max_ps(_mm_loadu_ps(&max[i]), x));
+    }
+#endif
+    for (; i < samples; i++) {
+      min[i] = (src[i] < min[i]) ? src[i] : min[i];
+      max[i] = (src[i] > max[i]) ? src[i] : max[i];
+    }
+  }
+  self->acquired += (ready) ? 1 : 0;
+  pthread_mutex_unlock(&self->mutex);
+  return ready;
+}
+
+size_t Envelope_read(Envelope *const self, float *const outMin,
+                     float *const outMax, size_t *const acquired) {
+  pthread_mutex_lock(&self->mutex);
+  size_t const frames = self->frames;
+  size_t const channels = self->channels;
+  size_t points = 0;
+  if (self->acquired && frames <= self->columns) {
+    memcpy(outMin, self->min, frames * channels * sizeof(float));
+    memcpy(outMax, self->max, frames * channels * sizeof(float));
+    points = frames;
+  } else if (self->acquired) {
+    // Lowest minimum and highest maximum of each column, the other halves
+    // of the reductions are discarded.
+    Decimate_minMax(self->min, frames, channels, self->columns, outMin,
+                    self->scratch);
+    Decimate_minMax(self->max, frames, channels, self->columns,
+                    self->scratch, outMax);
+    points = self->columns;
+  }
+  *acquired = self->acquired;
+  pthread_mutex_unlock(&self->mutex);
+  return points;
+}
+
+/* Resizes the edges for frames long waveforms. */
+static bool allocate(Envelope *const self, size_t const frames) {
+  free(self->min);
+  free(self->max);
+  self->min = calloc(frames * self->channels, sizeof(float));
+  self->max = calloc(frames * self->channels, sizeof(float));
+  self->acquired = 0;
+  if (!self->min || !self->max) {
+    free(self->min);
+    free(self->max);
+    self->min = NULL;
+    self->max = NULL;
+    self->frames = 0;
+    return false;
+  }
+  self->frames = frames;
+  return true;
+}
@@ -0,0 +1,248 @@
+
+#include "dsp/eye.h"
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define dassert(exp) assert(exp)
+
+#define EYE_BLOCK 4096
+#define EYE_MAX_SUBSTEPS 16
+#define EYE_PHASE_GAIN 0.05
+#define EYE_RATE_GAIN 0.002
+// The rate loop may only pull the unit interval this far from training.
+#define EYE_RATE_RANGE 0.05
+// Samples this close to the middle of the unit interval measure the height.
+#define EYE_CENTER_SPAN 0.1
+
+static void clearState(EyeDiagram *const self);
+static void onCrossing(EyeDiagram *const self, double const at);
+static void train(EyeDiagram *const self, double const at);
+static void flush(EyeDiagram *const self, size_t const count, float const yMin,
+                  float const yMax);
+
+EyeDiagram *EyeDiagram_create(size_t const width, size_t const height,
+                              double const nominalUi) {
+  dassert(nominalUi >= 0);
+  EyeDiagram *self = calloc(1, sizeof(EyeDiagram));
+  if (!self) {
+    return NULL;
+  }
+  self->nominalUi = nominalUi;
+  self->map = Persistence_create(width, height);
+  self->x = calloc(EYE_BLOCK, sizeof(float));
+  self->y = calloc(EYE_BLOCK, sizeof(float));
+  if (!self->map || !self->x || !self->y) {
+    Persistence_destroy(self->map);
+    free(self->x);
+    free(self->y);
+    free(self);
+    return NULL;
+  }
+  clearState(self);
+  pthread_mutex_init(&self->mutex, NULL);
+  return self;
+}
+
+void EyeDiagram_destroy(EyeDiagram *self) {
+  if (!self) {
+    return;
+  }
+  Persistence_destroy(self->map);
+  free(self->x);
+  free(self->y);
+  pthread_mutex_destroy(&self->mutex);
+  free(self);
+  return;
+}
+
+void EyeDiagram_reset(EyeDiagram *const self) {
+  pthread_mutex_lock(&self->mutex);
+  clearState(self);
+  Persistence_clear(self->map);
+  pthread_mutex_unlock(&self->mutex);
+  return;
+}
+
+void EyeDiagram_resync(EyeDiagram *const self) {
+  pthread_mutex_lock(&self->mutex);
+  self->phaseValid = false;
+  self->hasLast = false;
+  self->hasCrossing = false;
+  pthread_mutex_unlock(&self->mutex);
+  return;
+}
+
+void EyeDiagram_process(EyeDiagram *const self, float const *const src,
+                        size_t const frames, size_t const channels,
+                        float const yMin, float const yMax) {
+  pthread_mutex_lock(&self->mutex);
+  float const threshold = self->threshold;
+  size_t count = 0;
+  for (size_t i = 0; i < frames; i++) {
+    float const v = src[i * channels];
+    double const t = (double)(self->time + i);
+    float const last = self->last;
+    if (self->hasLast && (last < threshold) != (v < threshold)) {
+      onCrossing(self, t - 1 + (threshold - last) / (v - last));
+    }
+    self->last = v;
+    if (!self->hasLast || !self->phaseValid) {
+      self->hasLast = true;
+      continue;
+    }
+    double const ui = self->ui;
+    double u = (t - self->phase) / ui;
+    double const offset = u - floor(u);
+    if (fabs(offset - 0.5) < EYE_CENTER_SPAN) {
+      if (v >= threshold) {
+        self->highSum += v;
+        self->highSquares += (double)v * v;
+        self->highs++;
+      } else {
+        self->lowSum += v;
+        self->lowSquares += (double)v * v;
+        self->lows++;
+      }
+    }
+    // Fill the segment from the previous sample with about one point per
+    // map column, so that slowly sampled eyes still show connected traces.
+    double steps = ceil(self->map->width / (2 * ui));
+    steps = (steps < 1) ? 1 : (steps > EYE_MAX_SUBSTEPS) ? EYE_MAX_SUBSTEPS
+                                                         : steps;
+    for (int s = 1; s <= (int)steps; s++) {
+      double const fraction = s / steps;
+      u = (t - 1 + fraction - self->phase) / ui;
+      double x = (u + 0.5) / 2;
+      self->x[count] = (float)(x - floor(x));
+      self->y[count] = last + (float)fraction * (v - last);
+      if (++count == EYE_BLOCK) {
+        flush(self, count, yMin, yMax);
+        count = 0;
+      }
+    }
+  }
+  flush(self, count, yMin, yMax);
+  self->time += frames;
+  pthread_mutex_unlock(&self->mutex);
+  return;
+}
+
+void EyeDiagram_measure(EyeDiagram *const self, EyeMeasurement *const out) {
+  memset(out, 0, sizeof(EyeMeasurement));
+  pthread_mutex_lock(&self->mutex);
+  out->locked = self->phaseValid && self->ui > 0;
+  out->ui = self->ui;
+  if (self->highs > 1 && self->lows > 1) {
+    double const highMean = self->highSum / self->highs;
+    double const lowMean = self->lowSum / self->lows;
+    double const highVar =
+        self->highSquares / self->highs - highMean * highMean;
+    double const lowVar = self->lowSquares / self->lows - lowMean * lowMean;
+    out->height = (float)((highMean - 3 * sqrt(fmax(highVar, 0))) -
+                          (lowMean + 3 * sqrt(fmax(lowVar, 0))));
+  }
+  if (self->crossings > 1 && self->ui > 0) {
+    double const mean = self->crossingSum / self->crossings;
+    double const var = self->crossingSquares / self->crossings - mean * mean;
+    out->jitter = sqrt(fmax(var, 0));
+    out->width = 1 - 6 * out->jitter / self->ui;
+  }
+  pthread_mutex_unlock(&self->mutex);
+  return;
+}
+
+static void clearState(EyeDiagram *const self) {
+  self->ui = self->nominalUi;
+  self->trainedUi = self->nominalUi;
+  self->phase = 0;
+  self->phaseValid = false;
+  self->time = 0;
+  self->hasLast = false;
+  self->hasCrossing = false;
+  self->intervalCount = 0;
+  self->crossingSum = 0;
+  self->crossingSquares = 0;
+  self->crossings = 0;
+  self->highSum = 0;
+  self->highSquares = 0;
+  self->highs = 0;
+  self->lowSum = 0;
+  self->lowSquares = 0;
+  self->lows = 0;
+  return;
+}
+
+static void onCrossing(EyeDiagram *const self, double const at) {
+  if (self->ui == 0) {
+    train(self, at);
+    return;
+  }
+  if (!self->phaseValid) {
+    self->phase = at;
+    self->phaseValid = true;
+    return;
+  }
+  // Second order loop on the distance to the nearest symbol boundary.
+  double const k = round((at - self->phase) / self->ui);
+  double const boundary = self->phase + k * self->ui;
+  double const error = at - boundary;
+  self->phase = boundary + EYE_PHASE_GAIN * error;
+  if (self->nominalUi == 0) {
+    double const ui = self->ui + EYE_RATE_GAIN * error / ((k > 1) ? k : 1);
+    double const lo = self->trainedUi * (1 - EYE_RATE_RANGE);
+    double const hi = self->trainedUi * (1 + EYE_RATE_RANGE);
+    self->ui = (ui < lo) ? lo : (ui > hi) ? hi : ui;
+  }
+  self->crossingSum += error;
+  self->crossingSquares += error * error;
+  self->crossings++;
+  return;
+}
+
+static void train(EyeDiagram *const self, double const at) {
+  if (self->hasCrossing) {
+    self->intervals[self->intervalCount++] = at - self->lastCrossing;
+  }
+  self->lastCrossing = at;
+  self->hasCrossing = true;
+  if (self->intervalCount < EYE_TRAINING_CROSSINGS) {
+    return;
+  }
+  // The shortest spacing is one symbol, the others are multiples of it.
+  // Sub frame spacings are noise around the threshold.
+  double shortest = INFINITY;
+  for (size_t i = 0; i < self->intervalCount; i++) {
+    double const interval = self->intervals[i];
+    shortest = (interval >= 1 && interval < shortest) ? interval : shortest;
+  }
+  self->intervalCount = 0;
+  if (shortest == INFINITY) {
+    return;
+  }
+  double span = 0;
+  double symbols = 0;
+  for (size_t i = 0; i < EYE_TRAINING_CROSSINGS; i++) {
+    double const n = round(self->intervals[i] / shortest);
+    if (n >= 1) {
+      span += self->intervals[i];
+      symbols += n;
+    }
+  }
+  self->ui = span / symbols;
+  self->trainedUi = self->ui;
+  self->phase = at;
+  self->phaseValid = true;
+  return;
+}
+
+static void flush(EyeDiagram *const self, size_t const count, float const yMin,
+                  float const yMax) {
+  if (count == 0) {
+    return;
+  }
+  Persistence_accumulatePoints(self->map, self->x, self->y, count, 0, 1, yMin,
+                               yMax);
+  return;
+}
@@ -0,0 +1,372 @@
+
+#include "dsp/fft.h"
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#endif
+
+#define dassert(exp) assert(exp)
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+static bool isPowerOfTwo(size_t const size);
+static void radix4(float const *const xr, float const *const xi,
+                   float *const yr, float *const yi, size_t const m,
+                   size_t const s, float const *const wr,
+                   float const *const wi);
+static void radix2(float const *const xr, float const *const xi,
+                   float *const yr, float *const yi, size_t const s);
+
+FftPlan *FftPlan_create(size_t const size) {
+  if (size < 2 || !isPowerOfTwo(size)) {
+    return NULL;
+  }
+  FftPlan *self = calloc(1, sizeof(FftPlan));
+  if (!self) {
+    return NULL;
+  }
+  self->size = size;
+  self->workRe = calloc(size, sizeof(float));
+  self->workIm = calloc(size, sizeof(float));
+  bool ok = self->workRe && self->workIm;
+  // Pass k of the radix-4 chain works on sub-transforms of length n, it
+  // needs w^p, w^2p and w^3p for p < n / 4 with w = exp(-2 pi i / n).
+  size_t n = size;
+  while (ok && n >= 4) {
+    size_t const m = n / 4;
+    float *const wr = calloc(3 * m, sizeof(float));
+    float *const wi = calloc(3 * m, sizeof(float));
+    self->twiddleRe[self->stages] = wr;
+    self->twiddleIm[self->stages] = wi;
+    self->stages++;
+    ok = wr && wi;
+    for (size_t p = 0; ok && p < m; p++) {
+      for (size_t k = 1; k <= 3; k++) {
+        double const angle = -2 * M_PI * (double)(k * p) / (double)n;
+        wr[(k - 1) * m + p] = (float)cos(angle);
+        wi[(k - 1) * m + p] = (float)sin(angle);
+      }
+    }
+    n /= 4;
+  }
+  self->radix2 = n == 2;
+  if (!ok) {
+    FftPlan_destroy(self);
+    return NULL;
+  }
+  return self;
+}
+
+void FftPlan_destroy(FftPlan *self) {
+  if (!self) {
+    return;
+  }
+  for (size_t i = 0; i < self->stages; i++) {
+    free(self->twiddleRe[i]);
+    free(self->twiddleIm[i]);
+  }
+  free(self->workRe);
+  free(self->workIm);
+  free(self);
+  return;
+}
+
+void FftPlan_forward(FftPlan *const self, float *const re, float *const im) {
+  float *xr = re;
+  float *xi = im;
+  float *yr = self->workRe;
+  float *yi = self->workIm;
+  size_t n = self->size;
+  size_t s = 1;
+  for (size_t stage = 0; stage < self->stages; stage++) {
+    radix4(xr, xi, yr, yi, n / 4, s, self->twiddleRe[stage],
+           self->twiddleIm[stage]);
+    float *const tr = xr;
+    float *const ti = xi;
+    xr = yr;
+    xi = yi;
+    yr = tr;
+    yi = ti;
+    n /= 4;
+    s *= 4;
+  }
+  if (self->radix2) {
+    radix2(xr, xi, yr, yi, s);
+    xr = yr;
+    xi = yi;
+  }
+  // Passes ping-pong between the data and the plan, end in the data.
+  if (xr != re) {
+    memcpy(re, xr, self->size * sizeof(float));
+    memcpy(im, xi, self->size * sizeof(float));
+  }
+  return;
+}
+
+RealFftPlan *RealFftPlan_create(size_t const size) {
+  if (size < 4 || !isPowerOfTwo(size)) {
+    return NULL;
+  }
+  RealFftPlan *self = calloc(1, sizeof(RealFftPlan));
+  if (!self) {
+    return NULL;
+  }
+  size_t const half = size / 2;
+  self->size = size;
+  self->half = FftPlan_create(half);
+  self->splitRe = calloc(half + 1, sizeof(float));
+  self->splitIm = calloc(half + 1, sizeof(float));
+  self->re = calloc(half, sizeof(float));
+  self->im = calloc(half, sizeof(float));
+  if (!self->half || !self->splitRe || !self->splitIm || !self->re ||
+      !self->im) {
+    RealFftPlan_destroy(self);
+    return NULL;
+  }
+  for (size_t k = 0; k <= half; k++) {
+    double const angle = -2 * M_PI * (double)k / (double)size;
+    self->splitRe[k] = (float)cos(angle);
+    self->splitIm[k] = (float)sin(angle);
+  }
+  return self;
+}
+
+void RealFftPlan_destroy(RealFftPlan *self) {
+  if (!self) {
+    return;
+  }
+  FftPlan_destroy(self->half);
+  free(self->splitRe);
+  free(self->splitIm);
+  free(self->re);
+  free(self->im);
+  free(self);
+  return;
+}
+
+void RealFftPlan_forward(RealFftPlan *const self, float const *const src,
+                         float *const outRe, float *const outIm) {
+  size_t const half = self->size / 2;
+  float *const zr = self->re;
+  float *const zi = self->im;
+  // z[n] = x[2n] + i x[2n + 1].
+  size_t i = 0;
+#if defined(__SSE__)
+  for (; i + 4 <= half; i += 4) {
+    __m128 const a = _mm_loadu_ps(src + 2 * i);
+    __m128 const b = _mm_loadu_ps(src + 2 * i + 4);
+    _mm_storeu_ps(zr + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+    _mm_storeu_ps(zi + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+  }
+#endif
+  for (; i < half; i++) {
+    zr[i] = src[2 * i];
+    zi[i] = src[2 * i + 1];
+  }
+  FftPlan_forward(self->half, zr, zi);
+  // Even part E = (Z[k] + conj(Z[half - k])) / 2, odd part
+  // O = (Z[k] - conj(Z[half - k])) / 2i, X[k] = E + exp(-2 pi i k / size) O.
+  for (size_t k = 0; k <= half; k++) {
+    size_t const a = (k == half) ? 0 : k;
+    size_t const b = (k == 0) ? 0 : half - k;
+    float const er = (zr[a] + zr[b]) / 2;
+    float const ei = (zi[a] - zi[b]) / 2;
+    float const orr = (zi[a] + zi[b]) / 2;
+    float const oi = -(zr[a] - zr[b]) / 2;
+    float const wr = self->splitRe[k];
+    float const wi = self->splitIm[k];
+    outRe[k] = er + wr * orr - wi * oi;
+    outIm[k] = ei + wr * oi + wi * orr;
+  }
+  return;
+}
+
+static bool isPowerOfTwo(size_t const size) {
+  return size && (size & (size - 1)) == 0;
+}
+
+/* One Stockham radix-4 pass: for p < m and q < s, the 4 inputs
+ * x[q + s (p + j m)] give y[q + s (4 p + j)], j < 4. */
+static void radix4(float const *const xr, float const *const xi,
+                   float *const yr, float *const yi, size_t const m,
+                   size_t const s, float const *const wr,
+                   float const *const wi) {
+  size_t const sm = s * m;
+#if defined(__SSE__)
+  if (s == 1 && m >= 4) {
+    // First pass: four consecutive p per vector, outputs transposed so each
+    // p stores its 4 results together.
+    for (size_t p = 0; p < m; p += 4) {
+      __m128 const ar = _mm_loadu_ps(xr + p);
+      __m128 const ai = _mm_loadu_ps(xi + p);
+      __m128 const br = _mm_loadu_ps(xr + p + m);
+      __m128 const bi = _mm_loadu_ps(xi + p + m);
+      __m128 const cr = _mm_loadu_ps(xr + p + 2 * m);
+      __m128 const ci = _mm_loadu_ps(xi + p + 2 * m);
+      __m128 const dr = _mm_loadu_ps(xr + p + 3 * m);
+      __m128 const di = _mm_loadu_ps(xi + p + 3 * m);
+      __m128 const apcr = _mm_add_ps(ar, cr);
+      __m128 const apci = _mm_add_ps(ai, ci);
+      __m128 const amcr = _mm_sub_ps(ar, cr);
+      __m128 const amci = _mm_sub_ps(ai, ci);
+      __m128 const bpdr = _mm_add_ps(br, dr);
+      __m128 const bpdi = _mm_add_ps(bi, di);
+      // -i (b - d).
+      __m128 const jr = _mm_sub_ps(bi, di);
+      __m128 const ji = _mm_sub_ps(dr, br);
+      __m128 y0r = _mm_add_ps(apcr, bpdr);
+      __m128 y0i = _mm_add_ps(apci, bpdi);
+      __m128 const t1r = _mm_add_ps(amcr, jr);
+      __m128 const t1i = _mm_add_ps(amci, ji);
+      __m128 const t2r = _mm_sub_ps(apcr, bpdr);
+      __m128 const t2i = _mm_sub_ps(apci, bpdi);
+      __m128 const t3r = _mm_sub_ps(amcr, jr);
+      __m128 const t3i = _mm_sub_ps(amci, ji);
+      __m128 const w1r = _mm_loadu_ps(wr + p);
+      __m128 const w1i = _mm_loadu_ps(wi + p);
+      __m128 const w2r = _mm_loadu_ps(wr + m + p);
+      __m128 const w2i = _mm_loadu_ps(wi + m + p);
+      __m128 const w3r = _mm_loadu_ps(wr + 2 * m + p);
+      __m128 const w3i = _mm_loadu_ps(wi + 2 * m + p);
+      __m128 y1r = _mm_sub_ps(_mm_mul_ps(t1r, w1r), _mm_mul_ps(t1i, w1i));
+      __m128 y1i = _mm_add_ps(_mm_mul_ps(t1r, w1i), _mm_mul_ps(t1i, w1r));
+      __m128 y2r = _mm_sub_ps(_mm_mul_ps(t2r, w2r), _mm_mul_ps(t2i, w2i));
+      __m128 y2i = _mm_add_ps(_mm_mul_ps(t2r, w2i), _mm_mul_ps(t2i, w2r));
+      __m128 y3r = _mm_sub_ps(_mm_mul_ps(t3r, w3r), _mm_mul_ps(t3i, w3i));
+      __m128 y3i = _mm_add_ps(_mm_mul_ps(t3r, w3i), _mm_mul_ps(t3i, w3r));
+      _MM_TRANSPOSE4_PS(y0r, y1r, y2r, y3r);
+      _MM_TRANSPOSE4_PS(y0i, y1i, y2i, y3i);
+      _mm_storeu_ps(yr + 4 * p, y0r);
+      _mm_storeu_ps(yr + 4 * p + 4, y1r);
+      _mm_storeu_ps(yr + 4 * p + 8, y2r);
+      _mm_storeu_ps(yr + 4 * p + 12, y3r);
+      _mm_storeu_ps(yi + 4 * p, y0i);
+      _mm_storeu_ps(yi + 4 * p + 4, y1i);
+      _mm_storeu_ps(yi + 4 * p + 8, y2i);
+      _mm_storeu_ps(yi + 4 * p + 12, y3i);
+    }
+    return;
+  }
+  if (s >= 4) {
+    // Later passes: four consecutive q per vector, twiddles broadcast.
+    for (size_t p = 0; p < m; p++) {
+      __m128 const w1r = _mm_set1_ps(wr[p]);
+      __m128 const w1i = _mm_set1_ps(wi[p]);
+      __m128 const w2r = _mm_set1_ps(wr[m + p]);
+      __m128 const w2i = _mm_set1_ps(wi[m + p]);
+      __m128 const w3r = _mm_set1_ps(wr[2 * m + p]);
+      __m128 const w3i = _mm_set1_ps(wi[2 * m + p]);
+      float const *const xr0 = xr + s * p;
+      float const *const xi0 = xi + s * p;
+      float *const yr0 = yr + 4 * s * p;
+      float *const yi0 = yi + 4 * s * p;
+      for (size_t q = 0; q < s; q += 4) {
+        __m128 const ar = _mm_loadu_ps(xr0 + q);
+        __m128 const ai = _mm_loadu_ps(xi0 + q);
+        __m128 const br = _mm_loadu_ps(xr0 + q + sm);
+        __m128 const bi = _mm_loadu_ps(xi0 + q + sm);
+        __m128 const cr = _mm_loadu_ps(xr0 + q + 2 * sm);
+        __m128 const ci = _mm_loadu_ps(xi0 + q + 2 * sm);
+        __m128 const dr = _mm_loadu_ps(xr0 + q + 3 * sm);
+        __m128 const di = _mm_loadu_ps(xi0 + q + 3 * sm);
+        __m128 const apcr = _mm_add_ps(ar, cr);
+        __m128 const apci = _mm_add_ps(ai, ci);
+        __m128 const amcr = _mm_sub_ps(ar, cr);
+        __m128 const amci = _mm_sub_ps(ai, ci);
+        __m128 const bpdr = _mm_add_ps(br, dr);
+        __m128 const bpdi = _mm_add_ps(bi, di);
+        __m128 const jr = _mm_sub_ps(bi, di);
+        __m128 const ji = _mm_sub_ps(dr, br);
+        __m128 const t1r = _mm_add_ps(amcr, jr);
+        __m128 const t1i = _mm_add_ps(amci, ji);
+        __m128 const t2r = _mm_sub_ps(apcr, bpdr);
+        __m128 const t2i = _mm_sub_ps(apci, bpdi);
+        __m128 const t3r = _mm_sub_ps(amcr, jr);
+        __m128 const t3i = _mm_sub_ps(amci, ji);
+        _mm_storeu_ps(yr0 + q, _mm_add_ps(apcr, bpdr));
+        _mm_storeu_ps(yi0 + q, _mm_add_ps(apci, bpdi));
+        _mm_storeu_ps(yr0 + q + s, _mm_sub_ps(_mm_mul_ps(t1r, w1r),
+                                              _mm_mul_ps(t1i, w1i)));
+        _mm_storeu_ps(yi0 + q + s, _mm_add_ps(_mm_mul_ps(t1r, w1i),
+                                              _mm_mul_ps(t1i, w1r)));
+        _mm_storeu_ps(yr0 + q + 2 * s, _mm_sub_ps(_mm_mul_ps(t2r, w2r),
+                                                  _mm_mul_ps(t2i, w2i)));
+        _mm_storeu_ps(yi0 + q + 2 * s, _mm_add_ps(_mm_mul_ps(t2r, w2i),
+                                                  _mm_mul_ps(t2i, w2r)));
+        _mm_storeu_ps(yr0 + q + 3 * s, _mm_sub_ps(_mm_mul_ps(t3r, w3r),
+                                                  _mm_mul_ps(t3i, w3i)));
+        _mm_storeu_ps(yi0 + q + 3 * s, _mm_add_ps(_mm_mul_ps(t3r, w3i),
+                                                  _mm_mul_ps(t3i, w3r)));
+      }
+    }
+    return;
+  }
+#endif
+  for (size_t p = 0; p < m; p++) {
+    float const w1r = wr[p];
+    float const w1i = wi[p];
+    float const w2r = wr[m + p];
+    float const w2i = wi[m + p];
+    float const w3r = wr[2 * m + p];
+    float const w3i = wi[2 * m + p];
+    for (size_t q = 0; q < s; q++) {
+      size_t const x0 = q + s * p;
+      size_t const y0 = q + 4 * s * p;
+      float const apcr = xr[x0] + xr[x0 + 2 * sm];
+      float const apci = xi[x0] + xi[x0 + 2 * sm];
+      float const amcr = xr[x0] - xr[x0 + 2 * sm];
+      float const amci = xi[x0] - xi[x0 + 2 * sm];
+      float const bpdr = xr[x0 + sm] + xr[x0 + 3 * sm];
+      float const bpdi = xi[x0 + sm] + xi[x0 + 3 * sm];
+      float const jr = xi[x0 + sm] - xi[x0 + 3 * sm];
+      float const ji = xr[x0 + 3 * sm] - xr[x0 + sm];
+      float const t1r = amcr + jr;
+      float const t1i = amci + ji;
+      float const t2r = apcr - bpdr;
+      float const t2i = apci - bpdi;
+      float const t3r = amcr - jr;
+      float const t3i = amci - ji;
+      yr[y0] = apcr + bpdr;
+      yi[y0] = apci + bpdi;
+      yr[y0 + s] = t1r * w1r - t1i * w1i;
+      yi[y0 + s] = t1r * w1i + t1i * w1r;
+      yr[y0 + 2 * s] = t2r * w2r - t2i * w2i;
+      yi[y0 + 2 * s] = t2r * w2i + t2i * w2r;
+      yr[y0 + 3 * s] = t3r * w3r - t3i * w3i;
+      yi[y0 + 3 * s] = t3r * w3i + t3i * w3r;
+    }
+  }
+  return;
+}
+
+/* Last radix-2 pass of odd powers of two, length 2 transforms at stride s. */
+static void radix2(float const *const xr, float const *const xi,
+                   float *const yr, float *const yi, size_t const s) {
+  size_t q = 0;
+#if defined(__SSE__)
+  for (; q + 4 <= s; q += 4) {
+    __m128 const ar = _mm_loadu_ps(xr + q);
+    __m128 const ai = _mm_loadu_ps(xi + q);
+    __m128 const br = _mm_loadu_ps(xr + q + s);
+    __m128 const bi = _mm_loadu_ps(xi + q + s);
+    _mm_storeu_ps(yr + q, _mm_add_ps(ar, br));
+    _mm_storeu_ps(yi + q, _mm_add_ps(ai, bi));
+    _mm_storeu_ps(yr + q + s, _mm_sub_ps(ar, br));
+    _mm_storeu_ps(yi + q + s, _mm_sub_ps(ai, bi));
+  }
+#endif
+  for (; q < s; q++) {
+    float const ar = xr[q];
+    float const ai = xi[q];
+    yr[q] = ar + xr[q + s];
+    yi[q] = ai + xi[q + s];
+    yr[q + s] = ar - xr[q + s];
+    yi[q + s] = ai - xi[q + s];
+  }
+  return;
+}
@@ -0,0 +1,130 @@
+
+#include "dsp/interpolate.h"
+#include <assert.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#endif
+
+#define dassert(exp) assert(exp)
+
+#define INTERPOLATE_HALF (INTERPOLATE_TAPS / 2)
+
+static void fillTable(Interpolator *const self);
+static void interpolateLine(Interpolator const *const self, size_t const count,
+                            float *const dst);
+
+Interpolator *Interpolator_create(size_t const points,
+                                  size_t const maxFrames) {
+  dassert(points >= 1 && points <= INTERPOLATE_MAX_POINTS);
+  dassert(maxFrames > 0);
+  Interpolator *self = calloc(1, sizeof(Interpolator));
+  if (!self) {
+    return NULL;
+  }
+  self->points = points;
+  self->maxFrames = maxFrames;
+  self->table = calloc(INTERPOLATE_TAPS * points, sizeof(float));
+  self->line = calloc(maxFrames + INTERPOLATE_TAPS, sizeof(float));
+  if (!self->table || !self->line) {
+    free(self->table);
+    free(self->line);
+    free(self);
+    return NULL;
+  }
+  fillTable(self);
+  return self;
+}
+
+void Interpolator_destroy(Interpolator *self) {
+  if (!self) {
+    return;
+  }
+  free(self->table);
+  free(self->line);
+  free(self);
+  return;
+}
+
+size_t Interpolator_run(Interpolator *const self, float const *const src,
+                        size_t const frames, size_t const channels,
+                        size_t const first, size_t const count,
+                        float *const dst) {
+  dassert(frames <= self->maxFrames);
+  dassert(count >= 1 && first + count <= frames);
+  size_t const outCount = (count - 1) * self->points + 1;
+  // line[m] holds frame first - (INTERPOLATE_HALF - 1) + m, so the taps of
+  // the points following frame first + i start at line[i].
+  size_t const length = count + INTERPOLATE_TAPS - 1;
+  int64_t const origin = (int64_t)first - (INTERPOLATE_HALF - 1);
+  for (size_t ch = 0; ch < channels; ch++) {
+    for (size_t m = 0; m < length; m++) {
+      int64_t frame = origin + (int64_t)m;
+      frame = (frame < 0) ? 0 : frame;
+      frame = (frame < (int64_t)frames) ? frame : (int64_t)frames - 1;
+      self->line[m] = src[frame * channels + ch];
+    }
+    interpolateLine(self, count, dst + ch * outCount);
+  }
+  return outCount;
+}
+
+/* Blackman windowed sinc, one row of taps per phase, each row normalized to
+ * a unit DC gain. Phase 0 reduces to the sample itself. */
+static void fillTable(Interpolator *const self) {
+  size_t const points = self->points;
+  double const pi = acos(-1.0);
+  for (size_t p = 0; p < points; p++) {
+    double const t = (double)p / points;
+    double sum = 0;
+    double taps[INTERPOLATE_TAPS];
+    for (size_t k = 0; k < INTERPOLATE_TAPS; k++) {
+      double const u = (double)k - (INTERPOLATE_HALF - 1) - t;
+      double const sinc = (u == 0) ? 1 : sin(pi * u) / (pi * u);
+      double const window = 0.42 + 0.5 * cos(pi * u / INTERPOLATE_HALF) +
+                            0.08 * cos(2 * pi * u / INTERPOLATE_HALF);
+      taps[k] = sinc * window;
+      sum += taps[k];
+    }
+    for (size_t k = 0; k < INTERPOLATE_TAPS; k++) {
+      self->table[k * points + p] = (float)(taps[k] / sum);
+    }
+  }
+  return;
+}
+
+/* Runs the polyphase filter over self->line. Phases are contiguous in the
+ * table, so 4 of them are computed at once from each broadcast sample. */
+static void interpolateLine(Interpolator const *const self, size_t const count,
+                            float *const dst) {
+  size_t const points = self->points;
+  float const *const table = self->table;
+  float const *const line = self->line;
+  for (size_t i = 0; i + 1 < count; i++) {
+    float *const out = dst + i * points;
+    size_t p = 0;
+#if defined(__SSE__)
+    for (; p + 4 <= points; p += 4) {
+      __m128 acc = _mm_setzero_ps();
+      for (size_t k = 0; k < INTERPOLATE_TAPS; k++) {
+        __m128 const sample = _mm_set1_ps(line[i + k]);
+        __m128 const taps = _mm_loadu_ps(&table[k * points + p]);
+        acc = _mm_add_ps(acc, _mm_mul_ps(sample, taps));
+      }
+      _mm_storeu_ps(&out[p], acc);
+    }
+#endif
+    for (; p < points; p++) {
+      float acc = 0;
+      for (size_t k = 0; k < INTERPOLATE_TAPS; k++) {
+        acc += line[i + k] * table[k * points + p];
+      }
+      out[p] = acc;
+    }
+  }
+  // The last frame closes the strip, phase 0 is the sample itself.
+  dst[(count - 1) * points] = line[count - 1 + INTERPOLATE_HALF - 1];
+  return;
+}
@@ -0,0 +1,340 @@
+
+#include "dsp/persistence.h"
+#include <assert.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#endif
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#define dassert(exp) assert(exp)
+
+#define PERSISTENCE_BLOCK 1024
+#define PERSISTENCE_MAX_CHANNELS 4
+// Counts decayed below this are cleared, so they never turn denormal.
+#define PERSISTENCE_FLOOR 1e-3f
+
+typedef struct {
+  float at;
+  uint8_t rgb[3];
+} PaletteStop;
+
+static void buildPalette(Persistence *const self);
+static void toRows(float const *const src, size_t const count,
+                   float const scale, float const offset, float const maxRow,
+                   int32_t *const rows);
+static void addSpan(float *const column, int32_t const lo, int32_t const hi);
+static void toIndices(float const *const x, float const *const y,
+                      size_t const count, float const xScale,
+                      float const xOffset, float const yScale,
+                      float const yOffset, float const width,
+                      float const height, int32_t *const indices);
+static float maxCount(float const *const hits, size_t const count);
+
+Persistence *Persistence_create(size_t const width, size_t const height) {
+  dassert(width > 0 && height > 0);
+  Persistence *self = calloc(1, sizeof(Persistence));
+  if (!self) {
+    return NULL;
+  }
+  self->width = width;
+  self->height = height;
+  self->hits = calloc(width * height, sizeof(float));
+  self->rows = calloc(PERSISTENCE_BLOCK, sizeof(int32_t));
+  if (!self->hits || !self->rows) {
+    free(self->hits);
+    free(self->rows);
+    free(self);
+    return NULL;
+  }
+  buildPalette(self);
+  pthread_mutex_init(&self->mutex, NULL);
+  return self;
+}
+
+void Persistence_destroy(Persistence *self) {
+  if (!self) {
+    return;
+  }
+  free(self->hits);
+  free(self->rows);
+  pthread_mutex_destroy(&self->mutex);
+  free(self);
+  return;
+}
+
+void Persistence_clear(Persistence *const self) {
+  pthread_mutex_lock(&self->mutex);
+  memset(self->hits, 0, self->width * self->height * sizeof(float));
+  self->waveforms = 0;
+  pthread_mutex_unlock(&self->mutex);
+  return;
+}
+
+void Persistence_accumulate(Persistence *const self, float const *const src,
+                            size_t const frames, size_t const channels,
+                            float const yMin, float const yMax) {
+  dassert(channels > 0 && channels <= PERSISTENCE_MAX_CHANNELS);
+  if (frames == 0 || yMax <= yMin) {
+    return;
+  }
+  // row = (yMax - v) * scale, clamped to the histogram.
+  float const scale = self->height / (yMax - yMin);
+  float const offset = yMax * scale;
+  float const maxRow = (float)(self->height - 1);
+  size_t const blockFrames = PERSISTENCE_BLOCK / channels;
+  int32_t prev[PERSISTENCE_MAX_CHANNELS];
+  pthread_mutex_lock(&self->mutex);
+  for (size_t first = 0; first < frames; first += blockFrames) {
+    size_t const count =
+        (frames - first < blockFrames) ? frames - first : blockFrames;
+    toRows(src + first * channels, count * channels, scale, offset, maxRow,
+           self->rows);
+    for (size_t i = 0; i < count; i++) {
+      size_t const frame = first + i;
+      size_t const x = (size_t)((uint64_t)frame * self->width / frames);
+      // Sparse windows: the segment from the previous frame crosses every
+      // column in between, its row interpolated at each one.
+      size_t const from =
+          (frame > 0) ? (size_t)((uint64_t)(frame - 1) * self->width / frames)
+                      : x;
+      size_t const start = (x > from) ? from + 1 : x;
+      for (size_t ch = 0; ch < channels; ch++) {
+        int32_t const row = self->rows[i * channels + ch];
+        int32_t last = (frame > 0) ? prev[ch] : row;
+        for (size_t c = start; c <= x; c++) {
+          int32_t const at =
+              (x > from) ? prev[ch] + (int32_t)((int64_t)(row - prev[ch]) *
+                                                (int64_t)(c - from) /
+                                                (int64_t)(x - from))
+                         : row;
+          // Connect to the previous point, without hitting its pixel twice
+          // in the same column.
+          int32_t lo = at;
+          int32_t hi = at;
+          if (frame > 0 && last < at) {
+            lo = last + 1;
+          } else if (frame > 0 && last > at) {
+            hi = last - 1;
+          }
+          addSpan(self->hits + c * self->height, lo, hi);
+          last = at;
+        }
+        prev[ch] = row;
+      }
+    }
+  }
+  self->waveforms++;
+  pthread_mutex_unlock(&self->mutex);
+  return;
+}
+
+void Persistence_accumulatePoints(Persistence *const self,
+                                  float const *const x, float const *const y,
+                                  size_t const count, float const xMin,
+                                  float const xMax, float const yMin,
+                                  float const yMax) {
+  if (xMax <= xMin || yMax <= yMin) {
+    return;
+  }
+  float const xScale = self->width / (xMax - xMin);
+  float const yScale = self->height / (yMax - yMin);
+  pthread_mutex_lock(&self->mutex);
+  for (size_t first = 0; first < count; first += PERSISTENCE_BLOCK) {
+    size_t const block = (count - first < PERSISTENCE_BLOCK)
+                             ? count - first
+                             : PERSISTENCE_BLOCK;
+    toIndices(x + first, y + first, block, xScale, xMin * xScale, yScale,
+              yMax * yScale, self->width, self->height, self->rows);
+    for (size_t i = 0; i < block; i++) {
+      int32_t const index = self->rows[i];
+      if (index >= 0) {
+        self->hits[index] += 1;
+      }
+    }
+  }
+  pthread_mutex_unlock(&self->mutex);
+  return;
+}
+
+void Persistence_decay(Persistence *const self, float const factor) {
+  size_t const count = self->width * self->height;
+  size_t i = 0;
+  pthread_mutex_lock(&self->mutex);
+#if defined(__SSE__)
+  __m128 const f = _mm_set1_ps(factor);
+  __m128 const threshold = _mm_set1_ps(PERSISTENCE_FLOOR);
+  for (; i + 4 <= count; i += 4) {
+    __m128 const v = _mm_mul_ps(_mm_loadu_ps(self->hits + i), f);
+    _mm_storeu_ps(self->hits + i, _mm_and_ps(v, _mm_cmpge_ps(v, threshold)));
+  }
+#endif
+  for (; i < count; i++) {
+    float const v = self->hits[i] * factor;
+    self->hits[i] = (v >= PERSISTENCE_FLOOR) ? v : 0;
+  }
+  pthread_mutex_unlock(&self->mutex);
+  return;
+}
+
+void Persistence_render(Persistence *const self, uint8_t *const rgba) {
+  size_t const width = self->width;
+  size_t const height = self->height;
+  pthread_mutex_lock(&self->mutex);
+  float const peak = maxCount(self->hits, width * height);
+  float const gain =
+      (peak > 0) ? (PERSISTENCE_PALETTE_SIZE - 1) / log1pf(peak) : 0;
+  for (size_t y = 0; y < height; y++) {
+    uint8_t *const line = rgba + y * width * 4;
+    for (size_t x = 0; x < width; x++) {
+      float const hits = self->hits[x * height + y];
+      if (hits <= 0) {
+        memset(line + x * 4, 0, 4);
+        continue;
+      }
+      size_t index = (size_t)(log1pf(hits) * gain);
+      index = (index < PERSISTENCE_PALETTE_SIZE) ? index
+                                                 : PERSISTENCE_PALETTE_SIZE - 1;
+      memcpy(line + x * 4, self->palette[index], 4);
+    }
+  }
+  pthread_mutex_unlock(&self->mutex);
+  return;
+}
+
+static void buildPalette(Persistence *const self) {
+  // Cold to hot: rare paths stay visible, the common trace saturates.
+  static PaletteStop const stops[] = {
+      {0.00f, {0, 32, 160}},  {0.25f, {0, 200, 255}}, {0.50f, {0, 255, 64}},
+      {0.75f, {255, 220, 0}}, {0.90f, {255, 32, 0}},  {1.00f, {255, 255, 255}},
+  };
+  size_t const stopCount = sizeof(stops) / sizeof(stops[0]);
+  for (size_t i = 0; i < PERSISTENCE_PALETTE_SIZE; i++) {
+    float const at = i / (float)(PERSISTENCE_PALETTE_SIZE - 1);
+    size_t s = 1;
+    while (s < stopCount - 1 && stops[s].at < at) {
+      s++;
+    }
+    PaletteStop const *const a = &stops[s - 1];
+    PaletteStop const *const b = &stops[s];
+    float t = (at - a->at) / (b->at - a->at);
+    t = (t < 0) ? 0 : (t > 1) ? 1 : t;
+    for (size_t c = 0; c < 3; c++) {
+      self->palette[i][c] =
+          (uint8_t)(a->rgb[c] + t * (b->rgb[c] - a->rgb[c]) + 0.5f);
+    }
+    self->palette[i][3] = 255;
+  }
+  return;
+}
+
+static void toRows(float const *const src, size_t const count,
+                   float const scale, float const offset, float const maxRow,
+                   int32_t *const rows) {
+  size_t i = 0;
+#if defined(__SSE2__)
+  __m128 const s = _mm_set1_ps(-scale);
+  __m128 const o = _mm_set1_ps(offset);
+  __m128 const zero = _mm_setzero_ps();
+  __m128 const top = _mm_set1_ps(maxRow);
+  for (; i + 4 <= count; i += 4) {
+    __m128 v = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(src + i), s), o);
+    // max with NaN as first operand returns zero.
+    v = _mm_min_ps(_mm_max_ps(v, zero), top);
+    _mm_storeu_si128((__m128i *)(rows + i), _mm_cvttps_epi32(v));
+  }
+#endif
+  for (; i < count; i++) {
+    float v = offset - src[i] * scale;
+    v = (v > 0) ? v : 0;
+    v = (v < maxRow) ? v : maxRow;
+    rows[i] = (int32_t)v;
+  }
+  return;
+}
+
+static void addSpan(float *const column, int32_t const lo, int32_t const hi) {
+  int32_t y = lo;
+#if defined(__SSE__)
+  __m128 const one = _mm_set1_ps(1);
+  for (; y + 4 <= hi + 1; y += 4) {
+    _mm_storeu_ps(column + y, _mm_add_ps(_mm_loadu_ps(column + y), one));
+  }
+#endif
+  for (; y <= hi; y++) {
+    column[y] += 1;
+  }
+  return;
+}
+
+static void toIndices(float const *const x, float const *const y,
+                      size_t const count, float const xScale,
+                      float const xOffset, float const yScale,
+                      float const yOffset, float const width,
+                      float const height, int32_t *const indices) {
+  // column = x * xScale - xOffset, row = yOffset - y * yScale, both must
+  // land in the histogram. The index stays exact in float below 2^24.
+  size_t i = 0;
+#if defined(__SSE2__)
+  __m128 const xs = _mm_set1_ps(xScale);
+  __m128 const xo = _mm_set1_ps(xOffset);
+  __m128 const ys = _mm_set1_ps(yScale);
+  __m128 const yo = _mm_set1_ps(yOffset);
+  __m128 const w = _mm_set1_ps(width);
+  __m128 const h = _mm_set1_ps(height);
+  __m128 const zero = _mm_setzero_ps();
+  for (; i + 4 <= count; i += 4) {
+    __m128 const col = _mm_sub_ps(_mm_mul_ps(_mm_loadu_ps(x + i), xs), xo);
+    __m128 const row = _mm_sub_ps(yo, _mm_mul_ps(_mm_loadu_ps(y + i), ys));
+    // Ordered compares are false for NaN, which drops the point.
+    __m128 const inside =
+        _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(col, zero), _mm_cmplt_ps(col, w)),
+                   _mm_and_ps(_mm_cmpge_ps(row, zero), _mm_cmplt_ps(row, h)));
+    __m128 const colInt = _mm_cvtepi32_ps(_mm_cvttps_epi32(
+        _mm_and_ps(col, inside)));
+    __m128i const index = _mm_cvttps_epi32(
+        _mm_add_ps(_mm_mul_ps(colInt, h), _mm_and_ps(row, inside)));
+    __m128i const dropped = _mm_castps_si128(inside);
+    // Dropped lanes become -1: (index & inside) | ~inside.
+    _mm_storeu_si128((__m128i *)(indices + i),
+                     _mm_or_si128(_mm_and_si128(index, dropped),
+                                  _mm_andnot_si128(dropped,
+                                                   _mm_set1_epi32(-1))));
+  }
+#endif
+  for (; i < count; i++) {
+    float const col = x[i] * xScale - xOffset;
+    float const row = yOffset - y[i] * yScale;
+    if (!(col >= 0 && col < width && row >= 0 && row < height)) {
+      indices[i] = -1;
+      continue;
+    }
+    indices[i] = (int32_t)col * (int32_t)height + (int32_t)row;
+  }
+  return;
+}
+
+static float maxCount(float const *const hits, size_t const count) {
+  float peak = 0;
+  size_t i = 0;
+#if defined(__SSE__)
+  __m128 peak4 = _mm_setzero_ps();
+  for (; i + 4 <= count; i += 4) {
+    peak4 = _mm_max_ps(peak4, _mm_loadu_ps(hits + i));
+  }
+  float lanes[4];
+  _mm_storeu_ps(lanes, peak4);
+  for (size_t l = 0; l < 4; l++) {
+    peak = (lanes[l] > peak) ? lanes[l] : peak;
+  }
+#endif
+  for (; i < count; i++) {
+    peak = (hits[i] > peak) ? hits[i] : peak;
+  }
+  return peak;
+}
@@ -0,0 +1,82 @@
+
+#include "dsp/roll.h"
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define dassert(exp) assert(exp)
+
+static int32_t toRow(float const value, float const yMin, float const yMax,
+                     size_t const height);
+
+RollChart *RollChart_create(size_t const width, size_t const height,
+                            size_t const channels,
+                            uint8_t const (*const colors)[4]) {
+  dassert(width > 0 && height > 0);
+  dassert(channels > 0 && channels <= ROLL_MAX_CHANNELS);
+  RollChart *self = calloc(1, sizeof(RollChart));
+  if (!self) {
+    return NULL;
+  }
+  self->width = width;
+  self->height = height;
+  self->channels = channels;
+  self->pixels = calloc(width * height, 4);
+  if (!self->pixels) {
+    free(self);
+    return NULL;
+  }
+  memcpy(self->colors, colors, channels * sizeof(colors[0]));
+  return self;
+}
+
+void RollChart_destroy(RollChart *self) {
+  if (!self) {
+    return;
+  }
+  free(self->pixels);
+  free(self);
+  return;
+}
+
+void RollChart_clear(RollChart *const self) {
+  memset(self->pixels, 0, self->width * self->height * 4);
+  self->hasLast = false;
+  return;
+}
+
+uint8_t const *RollChart_draw(RollChart *const self, size_t const x,
+                              float const *const columnMin,
+                              float const *const columnMax, float const yMin,
+                              float const yMax) {
+  dassert(x < self->width);
+  uint8_t *const column = self->pixels + x * self->height * 4;
+  memset(column, 0, self->height * 4);
+  for (size_t ch = 0; ch < self->channels; ch++) {
+    int32_t top = toRow(columnMax[ch], yMin, yMax, self->height);
+    int32_t bottom = toRow(columnMin[ch], yMin, yMax, self->height);
+    int32_t const lastTop = self->lastTop[ch];
+    int32_t const lastBottom = self->lastBottom[ch];
+    self->lastTop[ch] = top;
+    self->lastBottom[ch] = bottom;
+    if (self->hasLast) {
+      top = (top > lastBottom) ? lastBottom : top;
+      bottom = (bottom < lastTop) ? lastTop : bottom;
+    }
+    for (int32_t y = top; y <= bottom; y++) {
+      memcpy(column + y * 4, self->colors[ch], 4);
+    }
+  }
+  self->hasLast = true;
+  return column;
+}
+
+/* Row of a value, clamped to the image. */
+static int32_t toRow(float const value, float const yMin, float const yMax,
+                     size_t const height) {
+  float const maxRow = height - 1;
+  float row = maxRow * (1 - (value - yMin) / (yMax - yMin));
+  row = (row > 0) ? row : 0;
+  row = (row < maxRow) ? row : maxRow;
+  return (int32_t)(row + 0.5f);
+}
@@ -0,0 +1,101 @@
+
+#include "dsp/segments.h"
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define dassert(exp) assert(exp)
+
+Segments *Segments_create(size_t const channels) {
+  dassert(channels > 0);
+  Segments *self = calloc(1, sizeof(Segments));
+  if (!self) {
+    return NULL;
+  }
+  self->channels = channels;
+  pthread_mutex_init(&self->mutex, NULL);
+  return self;
+}
+
+void Segments_destroy(Segments *self) {
+  if (!self) {
+    return;
+  }
+  free(self->samples);
+  free(self->stamps);
+  pthread_mutex_destroy(&self->mutex);
+  free(self);
+  return;
+}
+
+bool Segments_arm(Segments *const self, size_t const count,
+                  size_t const frames) {
+  dassert(count >= 1 && count <= SEGMENTS_MAX_COUNT);
+  dassert(frames > 0);
+  pthread_mutex_lock(&self->mutex);
+  self->filled = 0;
+  bool armed = count == self->count && frames == self->frames;
+  if (!armed) {
+    free(self->samples);
+    free(self->stamps);
+    self->samples = NULL;
+    self->stamps = NULL;
+    self->count = 0;
+    self->frames = 0;
+    if (frames * self->channels <= SEGMENTS_MAX_SAMPLES / count) {
+      self->samples = malloc(count * frames * self->channels * sizeof(float));
+      self->stamps = calloc(count, sizeof(SegmentStamp));
+    }
+    armed = self->samples && self->stamps;
+    if (armed) {
+      self->count = count;
+      self->frames = frames;
+    } else {
+      free(self->samples);
+      free(self->stamps);
+      self->samples = NULL;
+      self->stamps = NULL;
+    }
+  }
+  pthread_mutex_unlock(&self->mutex);
+  return armed;
+}
+
+size_t Segments_store(Segments *const self, float const *const src,
+                      size_t const frames, uint64_t const trigger) {
+  pthread_mutex_lock(&self->mutex);
+  if (frames == self->frames && self->filled < self->count) {
+    size_t const samples = frames * self->channels;
+    memcpy(self->samples + self->filled * samples, src,
+           samples * sizeof(float));
+    SegmentStamp *const stamp = &self->stamps[self->filled];
+    stamp->trigger = trigger;
+    clock_gettime(CLOCK_REALTIME, &stamp->time);
+    self->filled++;
+  }
+  size_t const left = self->count - self->filled;
+  pthread_mutex_unlock(&self->mutex);
+  return left;
+}
+
+size_t Segments_filled(Segments *const self) {
+  pthread_mutex_lock(&self->mutex);
+  size_t const filled = self->filled;
+  pthread_mutex_unlock(&self->mutex);
+  return filled;
+}
+
+bool Segments_read(Segments *const self, size_t const index, float *const dst,
+                   SegmentStamp *const stamp) {
+  pthread_mutex_lock(&self->mutex);
+  bool const stored = index < self->filled;
+  if (stored && dst) {
+    size_t const samples = self->frames * self->channels;
+    memcpy(dst, self->samples + index * samples, samples * sizeof(float));
+  }
+  if (stored && stamp) {
+    *stamp = self->stamps[index];
+  }
+  pthread_mutex_unlock(&self->mutex);
+  return stored;
+}
@@ -0,0 +1,336 @@
+
+#include "dsp/spectrum.h"
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#endif
+
+#define dassert(exp) assert(exp)
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+// Floor of the dB conversion, far below float rounding noise.
+#define SPECTRUM_MIN_POWER 1e-30f
+
+static bool applyConfiguration(Spectrum *const self);
+static void transform(Spectrum *const self);
+static void accumulate(Spectrum *const self);
+static void freeBuffers(Spectrum *const self);
+static void reduceColumns(float const *const power, size_t const bins,
+                          size_t const columns, float *const outDb);
+
+Spectrum *Spectrum_create(bool const complex) {
+  Spectrum *self = calloc(1, sizeof(Spectrum));
+  if (!self) {
+    return NULL;
+  }
+  self->complex = complex;
+  self->requestedSize = 4096;
+  self->requestedWindow = SPECTRUM_WINDOW_HANN;
+  self->requestedAverage = SPECTRUM_AVERAGE_NONE;
+  self->requestedAverages = 1;
+  pthread_mutex_init(&self->mutex, NULL);
+  return self;
+}
+
+void Spectrum_destroy(Spectrum *self) {
+  if (!self) {
+    return;
+  }
+  freeBuffers(self);
+  free(self->power);
+  pthread_mutex_destroy(&self->mutex);
+  free(self);
+  return;
+}
+
+bool Spectrum_configure(Spectrum *const self, size_t const size,
+                        SpectrumWindow const window,
+                        SpectrumAverage const average, size_t const averages) {
+  if (size < SPECTRUM_MIN_SIZE || size > SPECTRUM_MAX_SIZE ||
+      (size & (size - 1)) != 0) {
+    return false;
+  }
+  pthread_mutex_lock(&self->mutex);
+  self->requestedSize = size;
+  self->requestedWindow = window;
+  self->requestedAverage = average;
+  self->requestedAverages = (averages) ? averages : 1;
+  pthread_mutex_unlock(&self->mutex);
+  return true;
+}
+
+void Spectrum_reset(Spectrum *const self) {
+  pthread_mutex_lock(&self->mutex);
+  self->resetRequested = true;
+  pthread_mutex_unlock(&self->mutex);
+  return;
+}
+
+bool Spectrum_process(Spectrum *const self, float const *const src,
+                      size_t const frames, size_t const channels,
+                      size_t *const consumed, bool *const transformed) {
+  dassert(!self->complex || channels >= 2);
+  *consumed = frames;
+  *transformed = false;
+  if (!applyConfiguration(self)) {
+    return false;
+  }
+  size_t const width = (self->complex) ? 2 : 1;
+  size_t count = self->size - self->fill;
+  count = (frames < count) ? frames : count;
+  float *const dst = self->block + self->fill * width;
+  if (channels == width) {
+    memcpy(dst, src, count * width * sizeof(float));
+  } else {
+    for (size_t f = 0; f < count; f++) {
+      memcpy(dst + f * width, src + f * channels, width * sizeof(float));
+    }
+  }
+  self->fill += count;
+  if (self->fill == self->size) {
+    transform(self);
+    accumulate(self);
+    self->fill = 0;
+    *transformed = true;
+  }
+  *consumed = count;
+  return true;
+}
+
+uint64_t Spectrum_read(Spectrum *const self, size_t const columns,
+                       float *const outDb) {
+  pthread_mutex_lock(&self->mutex);
+  uint64_t const count = self->count;
+  if (count) {
+    reduceColumns(self->power, self->bins, columns, outDb);
+  }
+  pthread_mutex_unlock(&self->mutex);
+  return count;
+}
+
+void Spectrum_readLatest(Spectrum *const self, size_t const columns,
+                         float *const outDb) {
+  size_t const bins = (self->complex) ? self->size : self->size / 2 + 1;
+  reduceColumns(self->latest, bins, columns, outDb);
+  return;
+}
+
+/* Picks up the requested configuration, rebuilding plans and windows when
+ * the size or the window changed. */
+static bool applyConfiguration(Spectrum *const self) {
+  pthread_mutex_lock(&self->mutex);
+  size_t const size = self->requestedSize;
+  SpectrumWindow const window = self->requestedWindow;
+  bool restart = self->resetRequested ||
+                 self->average != self->requestedAverage ||
+                 self->averages != self->requestedAverages;
+  self->average = self->requestedAverage;
+  self->averages = self->requestedAverages;
+  self->resetRequested = false;
+  if (restart) {
+    self->count = 0;
+  }
+  pthread_mutex_unlock(&self->mutex);
+  if (self->plan || self->realPlan) {
+    if (size == self->size && window == self->window) {
+      return true;
+    }
+  }
+  freeBuffers(self);
+  size_t const bins = (self->complex) ? size : size / 2 + 1;
+  self->size = size;
+  self->window = window;
+  self->fill = 0;
+  if (self->complex) {
+    self->plan = FftPlan_create(size);
+  } else {
+    self->realPlan = RealFftPlan_create(size);
+  }
+  self->coefficients = calloc(size, sizeof(float));
+  self->block = calloc(size * 2, sizeof(float));
+  self->re = calloc(size, sizeof(float));
+  self->im = calloc(size, sizeof(float));
+  self->latest = calloc(bins, sizeof(float));
+  float *const power = calloc(bins, sizeof(float));
+  if ((!self->plan && !self->realPlan) || !self->coefficients ||
+      !self->block || !self->re || !self->im || !self->latest || !power) {
+    freeBuffers(self);
+    free(power);
+    return false;
+  }
+  // Cosine sum windows, w[n] = sum (-1)^k a[k] cos(2 pi k n / size).
+  static double const terms[][5] = {
+      [SPECTRUM_WINDOW_HANN] = {0.5, 0.5, 0, 0, 0},
+      [SPECTRUM_WINDOW_BLACKMAN_HARRIS] = {0.35875, 0.48829, 0.14128, 0.01168,
+                                           0},
+      [SPECTRUM_WINDOW_FLAT_TOP] = {0.21557895, 0.41663158, 0.277263158,
+                                    0.083578947, 0.006947368},
+  };
+  double sum = 0;
+  for (size_t n = 0; n < size; n++) {
+    double w = 0;
+    for (size_t k = 0; k < 5; k++) {
+      double const a = terms[window][k] * ((k & 1) ? -1 : 1);
+      w += a * cos(2 * M_PI * (double)(k * n) / (double)size);
+    }
+    self->coefficients[n] = (float)w;
+    sum += w;
+  }
+  // A full scale tone reads 0 dB: sum(w)^2 for complex tones, real tones
+  // split their power between the two sides of the spectrum.
+  self->normalization = (float)(((self->complex) ? 1 : 4) / (sum * sum));
+  pthread_mutex_lock(&self->mutex);
+  free(self->power);
+  self->power = power;
+  self->bins = bins;
+  self->count = 0;
+  pthread_mutex_unlock(&self->mutex);
+  return true;
+}
+
+/* Windows the block, transforms it and stores the normalized bin powers in
+ * latest, negative frequencies first for complex spectra. */
+static void transform(Spectrum *const self) {
+  size_t const size = self->size;
+  float const *const w = self->coefficients;
+  float *const re = self->re;
+  float *const im = self->im;
+  float *const block = self->block;
+  size_t i = 0;
+  if (self->complex) {
+#if defined(__SSE__)
+    for (; i + 4 <= size; i += 4) {
+      __m128 const a = _mm_loadu_ps(block + 2 * i);
+      __m128 const b = _mm_loadu_ps(block + 2 * i + 4);
+      __m128 const c = _mm_loadu_ps(w + i);
+      __m128 const r = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+      __m128 const m = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+      _mm_storeu_ps(re + i, _mm_mul_ps(r, c));
+      _mm_storeu_ps(im + i, _mm_mul_ps(m, c));
+    }
+#endif
+    for (; i < size; i++) {
+      re[i] = block[2 * i] * w[i];
+      im[i] = block[2 * i + 1] * w[i];
+    }
+    FftPlan_forward(self->plan, re, im);
+  } else {
+#if defined(__SSE__)
+    for (; i + 4 <= size; i += 4) {
+      _mm_storeu_ps(block + i, _mm_mul_ps(_mm_loadu_ps(block + i),
+                                          _mm_loadu_ps(w + i)));
+    }
+#endif
+    for (; i < size; i++) {
+      block[i] *= w[i];
+    }
+    RealFftPlan_forward(self->realPlan, block, re, im);
+  }
+  size_t const bins = (self->complex) ? size : size / 2 + 1;
+  // Complex spectra start at bin size / 2, the most negative frequency.
+  size_t const shift = (self->complex) ? size / 2 : 0;
+  float *const latest = self->latest;
+  size_t b = 0;
+#if defined(__SSE__)
+  __m128 const scale = _mm_set1_ps(self->normalization);
+  for (; b + 4 <= bins; b += 4) {
+    size_t const k = (b + shift) % bins;
+    __m128 const r = _mm_loadu_ps(re + k);
+    __m128 const m = _mm_loadu_ps(im + k);
+    __m128 const p = _mm_add_ps(_mm_mul_ps(r, r), _mm_mul_ps(m, m));
+    _mm_storeu_ps(latest + b, _mm_mul_ps(p, scale));
+  }
+#endif
+  for (; b < bins; b++) {
+    size_t const k = (b + shift) % bins;
+    latest[b] = (re[k] * re[k] + im[k] * im[k]) * self->normalization;
+  }
+  return;
+}
+
+static void accumulate(Spectrum *const self) {
+  pthread_mutex_lock(&self->mutex);
+  size_t const bins = self->bins;
+  float const *const latest = self->latest;
+  float *const power = self->power;
+  SpectrumAverage average = self->average;
+  average = (self->count == 0) ? SPECTRUM_AVERAGE_NONE : average;
+  size_t const n = (self->count + 1 < self->averages) ? self->count + 1
+                                                      : self->averages;
+  float const weight = 1.0f / n;
+  float const decay = expf(-1.0f / self->averages);
+  size_t b = 0;
+#if defined(__SSE__)
+  __m128 const w = _mm_set1_ps(weight);
+  __m128 const d = _mm_set1_ps(decay);
+  for (; b + 4 <= bins; b += 4) {
+    __m128 const l = _mm_loadu_ps(latest + b);
+    __m128 const p = _mm_loadu_ps(power + b);
+    __m128 v = l;
+    if (average == SPECTRUM_AVERAGE_LINEAR) {
+      v = _mm_add_ps(p, _mm_mul_ps(_mm_sub_ps(l, p), w));
+    } else if (average == SPECTRUM_AVERAGE_PEAK_HOLD) {
+      v = _mm_max_ps(l, _mm_mul_ps(p, d));
+    } else if (average == SPECTRUM_AVERAGE_MAX) {
+      v = _mm_max_ps(l, p);
+    }
+    _mm_storeu_ps(power + b, v);
+  }
+#endif
+  for (; b < bins; b++) {
+    float const l = latest[b];
+    float const p = power[b];
+    float v = l;
+    if (average == SPECTRUM_AVERAGE_LINEAR) {
+      v = p + (l - p) * weight;
+    } else if (average == SPECTRUM_AVERAGE_PEAK_HOLD) {
+      v = (l > p * decay) ? l : p * decay;
+    } else if (average == SPECTRUM_AVERAGE_MAX) {
+      v = (l > p) ? l : p;
+    }
+    power[b] = v;
+  }
+  self->count++;
+  pthread_mutex_unlock(&self->mutex);
+  return;
+}
+
+static void freeBuffers(Spectrum *const self) {
+  FftPlan_destroy(self->plan);
+  RealFftPlan_destroy(self->realPlan);
+  self->plan = NULL;
+  self->realPlan = NULL;
+  free(self->coefficients);
+  free(self->block);
+  free(self->re);
+  free(self->im);
+  free(self->latest);
+  self->coefficients = NULL;
+  self->block = NULL;
+  self->re = NULL;
+  self->im = NULL;
+  self->latest = NULL;
+  return;
+}
+
+/* Highest bin power of each column, in dB. */
+static void reduceColumns(float const *const power, size_t const bins,
+                          size_t const columns, float *const outDb) {
+  for (size_t c = 0; c < columns; c++) {
+    size_t const first = (size_t)((uint64_t)c * bins / columns);
+    size_t last = (size_t)((uint64_t)(c + 1) * bins / columns);
+    last = (last > first) ? last : first + 1;
+    float peak = SPECTRUM_MIN_POWER;
+    for (size_t b = first; b < last; b++) {
+      peak = (power[b] > peak) ? power[b] : peak;
+    }
+    outDb[c] = 10 * log10f(peak);
+  }
+  return;
+}
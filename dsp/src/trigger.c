@@ -0,0 +1,405 @@
+
+#include "dsp/trigger.h"
+#include <math.h>
+#include <stdint.h>
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#endif
+
+static size_t findOutside(float const *const src, size_t const stride,
+                          size_t i, size_t const count, float const low,
+                          float const high);
+static size_t findPatternChange(float const *const src,
+                                size_t const channels, size_t i,
+                                size_t const count, float const level,
+                                uint8_t const care, uint8_t const value,
+                                bool const matched);
+static bool patternMatches(float const *const frame, size_t const channels,
+                           float const level, uint8_t const care,
+                           uint8_t const value);
+static bool regionNext(Trigger *const self, float const *const values,
+                       size_t const frames, size_t const stride,
+                       uint64_t const firstFrame, uint64_t *const trigger);
+static bool patternNext(Trigger *const self, float const *const src,
+                        size_t const frames, size_t const channels,
+                        uint64_t const firstFrame, uint64_t *const trigger);
+static TriggerRegion classify(float const v, float const low,
+                              float const high);
+static bool onRegionChange(Trigger *const self, TriggerRegion const from,
+                           TriggerRegion const to, uint64_t const t);
+static bool widthMatches(Trigger const *const self, uint64_t const width);
+static bool slopeMatches(TriggerSlope const slope, bool const rising);
+static size_t startIndex(Trigger *const self, size_t const frames,
+                         uint64_t const firstFrame, bool *const gap);
+
+void EdgeTrigger_init(EdgeTrigger *const self, TriggerSlope const slope,
+                      float const level, float const hysteresis,
+                      uint64_t const holdoff) {
+  self->slope = slope;
+  self->level = level;
+  self->hysteresis = hysteresis;
+  self->holdoff = holdoff;
+  self->channel = 0;
+  EdgeTrigger_reset(self);
+  return;
+}
+
+void EdgeTrigger_reset(EdgeTrigger *const self) {
+  self->state = EDGE_TRIGGER_DISARMED;
+  self->nextAllowed = 0;
+  return;
+}
+
+bool EdgeTrigger_next(EdgeTrigger *const self, float const *const src,
+                      size_t const frames, size_t const channels,
+                      uint64_t const firstFrame, uint64_t *const trigger) {
+  float const *const values = &src[self->channel];
+  float const armLow = self->level - self->hysteresis;
+  float const armHigh = self->level + self->hysteresis;
+  // v >= level <=> v > previous float, v <= level <=> v < next float.
+  float const belowLevel = nextafterf(self->level, -INFINITY);
+  float const aboveLevel = nextafterf(self->level, INFINITY);
+  bool const rising = self->slope != TRIGGER_SLOPE_FALLING;
+  bool const falling = self->slope != TRIGGER_SLOPE_RISING;
+  size_t i = 0;
+  if (self->nextAllowed > firstFrame) {
+    uint64_t const skip = self->nextAllowed - firstFrame;
+    i = (skip < frames) ? (size_t)skip : frames;
+  }
+  while (i < frames) {
+    switch (self->state) {
+    case EDGE_TRIGGER_DISARMED:
+      i = findOutside(values, channels, i, frames, (rising) ? armLow : -INFINITY,
+                      (falling) ? armHigh : INFINITY);
+      if (i < frames) {
+        self->state = (values[i * channels] < armLow)
+                          ? EDGE_TRIGGER_ARMED_RISING
+                          : EDGE_TRIGGER_ARMED_FALLING;
+      }
+      break;
+    case EDGE_TRIGGER_ARMED_RISING:
+      i = findOutside(values, channels, i, frames, -INFINITY, belowLevel);
+      break;
+    case EDGE_TRIGGER_ARMED_FALLING:
+      i = findOutside(values, channels, i, frames, aboveLevel, INFINITY);
+      break;
+    }
+    if (i >= frames || self->state == EDGE_TRIGGER_DISARMED) {
+      continue;
+    }
+    if (self->state == EDGE_TRIGGER_ARMED_RISING
+            ? values[i * channels] >= self->level
+            : values[i * channels] <= self->level) {
+      self->state = EDGE_TRIGGER_DISARMED;
+      *trigger = firstFrame + i;
+      self->nextAllowed = *trigger + ((self->holdoff) ? self->holdoff : 1);
+      return true;
+    }
+  }
+  return false;
+}
+
+void Trigger_init(Trigger *const self) {
+  self->type = TRIGGER_TYPE_EDGE;
+  self->slope = TRIGGER_SLOPE_RISING;
+  self->level = 0;
+  self->hysteresis = 0;
+  self->low = -0.5f;
+  self->high = 0.5f;
+  self->widthCondition = TRIGGER_WIDTH_LESS;
+  self->widthMin = 0;
+  self->widthMax = UINT64_MAX;
+  self->windowCondition = TRIGGER_WINDOW_ENTER;
+  self->patternCare = 0;
+  self->patternValue = 0;
+  self->holdoff = 0;
+  self->channel = 0;
+  EdgeTrigger_init(&self->edge, self->slope, self->level, self->hysteresis,
+                   self->holdoff);
+  Trigger_reset(self);
+  return;
+}
+
+void Trigger_reset(Trigger *const self) {
+  EdgeTrigger_reset(&self->edge);
+  self->region = TRIGGER_REGION_UNKNOWN;
+  self->midFrom = TRIGGER_REGION_UNKNOWN;
+  self->extreme = TRIGGER_REGION_UNKNOWN;
+  self->patternMatched = true; // Needs to see a mismatch first.
+  self->nextFrame = 0;
+  self->nextAllowed = 0;
+  return;
+}
+
+bool Trigger_next(Trigger *const self, float const *const src,
+                  size_t const frames, size_t const channels,
+                  uint64_t const firstFrame, uint64_t *const trigger) {
+  switch (self->type) {
+  case TRIGGER_TYPE_EDGE:
+    self->edge.slope = self->slope;
+    self->edge.level = self->level;
+    self->edge.hysteresis = self->hysteresis;
+    self->edge.holdoff = self->holdoff;
+    self->edge.channel = self->channel;
+    return EdgeTrigger_next(&self->edge, src, frames, channels, firstFrame,
+                            trigger);
+  case TRIGGER_TYPE_PATTERN:
+    return patternNext(self, src, frames, channels, firstFrame, trigger);
+  default:
+    return regionNext(self, &src[self->channel], frames, channels, firstFrame,
+                      trigger);
+  }
+}
+
+/* Where to resume in the block, gap is set when frames were skipped. */
+static size_t startIndex(Trigger *const self, size_t const frames,
+                         uint64_t const firstFrame, bool *const gap) {
+  *gap = self->nextFrame < firstFrame;
+  if (*gap) {
+    return 0;
+  }
+  uint64_t const skip = self->nextFrame - firstFrame;
+  return (skip < frames) ? (size_t)skip : frames;
+}
+
+static bool regionNext(Trigger *const self, float const *const values,
+                       size_t const frames, size_t const stride,
+                       uint64_t const firstFrame, uint64_t *const trigger) {
+  float low = self->low;
+  float high = self->high;
+  if (self->type == TRIGGER_TYPE_PULSE_WIDTH) {
+    low = self->level - self->hysteresis;
+    high = self->level + self->hysteresis;
+  }
+  // LOW is left at v >= low, HIGH at v <= high, see EdgeTrigger_next.
+  float const belowLow = nextafterf(low, -INFINITY);
+  float const aboveHigh = nextafterf(high, INFINITY);
+  bool gap;
+  size_t i = startIndex(self, frames, firstFrame, &gap);
+  if (gap) {
+    self->region = TRIGGER_REGION_UNKNOWN;
+  }
+  if (i < frames && self->region == TRIGGER_REGION_UNKNOWN) {
+    self->region = classify(values[i * stride], low, high);
+    self->midFrom = TRIGGER_REGION_UNKNOWN;
+    self->extreme = TRIGGER_REGION_UNKNOWN;
+    i++;
+  }
+  while (i < frames) {
+    switch (self->region) {
+    case TRIGGER_REGION_LOW:
+      i = findOutside(values, stride, i, frames, -INFINITY, belowLow);
+      break;
+    case TRIGGER_REGION_HIGH:
+      i = findOutside(values, stride, i, frames, aboveHigh, INFINITY);
+      break;
+    default:
+      i = findOutside(values, stride, i, frames, low, high);
+      break;
+    }
+    if (i >= frames) {
+      break;
+    }
+    uint64_t const t = firstFrame + i;
+    TriggerRegion const to = classify(values[i * stride], low, high);
+    bool const fire = onRegionChange(self, self->region, to, t);
+    self->region = to;
+    i++;
+    if (fire && t >= self->nextAllowed) {
+      self->nextAllowed = t + ((self->holdoff) ? self->holdoff : 1);
+      self->nextFrame = firstFrame + i;
+      *trigger = t;
+      return true;
+    }
+  }
+  self->nextFrame = firstFrame + frames;
+  return false;
+}
+
+static bool patternNext(Trigger *const self, float const *const src,
+                        size_t const frames, size_t const channels,
+                        uint64_t const firstFrame, uint64_t *const trigger) {
+  uint8_t const care = self->patternCare & ((1u << channels) - 1);
+  bool gap;
+  size_t i = startIndex(self, frames, firstFrame, &gap);
+  if (gap) {
+    self->patternMatched = true;
+  }
+  while (i < frames) {
+    i = findPatternChange(src, channels, i, frames, self->level, care,
+                          self->patternValue, self->patternMatched);
+    if (i >= frames) {
+      break;
+    }
+    self->patternMatched = !self->patternMatched;
+    uint64_t const t = firstFrame + i;
+    i++;
+    if (self->patternMatched && t >= self->nextAllowed) {
+      self->nextAllowed = t + ((self->holdoff) ? self->holdoff : 1);
+      self->nextFrame = firstFrame + i;
+      *trigger = t;
+      return true;
+    }
+  }
+  self->nextFrame = firstFrame + frames;
+  return false;
+}
+
+static TriggerRegion classify(float const v, float const low,
+                              float const high) {
+  if (v < low) {
+    return TRIGGER_REGION_LOW;
+  }
+  return (v > high) ? TRIGGER_REGION_HIGH : TRIGGER_REGION_MID;
+}
+
+/* Updates the region history, returns true if the change is a trigger. */
+static bool onRegionChange(Trigger *const self, TriggerRegion const from,
+                           TriggerRegion const to, uint64_t const t) {
+  bool fire = false;
+  if (to == TRIGGER_REGION_MID) {
+    self->midFrom = from;
+    self->midAt = t;
+    if (self->type == TRIGGER_TYPE_WINDOW) {
+      fire = self->windowCondition == TRIGGER_WINDOW_ENTER;
+    }
+    return fire;
+  }
+  // Entering LOW or HIGH, possibly straight from the other one.
+  TriggerRegion const origin =
+      (from == TRIGGER_REGION_MID) ? self->midFrom : from;
+  uint64_t const crossingStart = (from == TRIGGER_REGION_MID) ? self->midAt : t;
+  bool const crossed = origin != TRIGGER_REGION_UNKNOWN && origin != to;
+  bool const rising = to == TRIGGER_REGION_HIGH;
+  switch (self->type) {
+  case TRIGGER_TYPE_WINDOW:
+    fire = from == TRIGGER_REGION_MID &&
+           self->windowCondition == TRIGGER_WINDOW_EXIT;
+    break;
+  case TRIGGER_TYPE_RUNT:
+    // Came back to where the pulse started without crossing the other
+    // threshold: a positive runt returns to LOW.
+    fire = from == TRIGGER_REGION_MID && origin == to &&
+           slopeMatches(self->slope, !rising);
+    break;
+  case TRIGGER_TYPE_SLEW:
+    fire = crossed && slopeMatches(self->slope, rising) &&
+           widthMatches(self, t - crossingStart);
+    break;
+  case TRIGGER_TYPE_PULSE_WIDTH:
+    // The pulse is the time spent in the extreme we just left: a positive
+    // pulse ends when entering LOW.
+    fire = crossed && self->extreme == origin &&
+           slopeMatches(self->slope, !rising) &&
+           widthMatches(self, t - self->extremeAt);
+    break;
+  default:
+    break;
+  }
+  if (self->extreme != to) {
+    self->extreme = to;
+    self->extremeAt = t;
+  }
+  return fire;
+}
+
+static bool widthMatches(Trigger const *const self, uint64_t const width) {
+  switch (self->widthCondition) {
+  case TRIGGER_WIDTH_LESS:
+    return width < self->widthMax;
+  case TRIGGER_WIDTH_GREATER:
+    return width > self->widthMin;
+  default:
+    return width >= self->widthMin && width <= self->widthMax;
+  }
+}
+
+static bool slopeMatches(TriggerSlope const slope, bool const rising) {
+  return slope == TRIGGER_SLOPE_EITHER ||
+         (slope == TRIGGER_SLOPE_RISING) == rising;
+}
+
+static bool patternMatches(float const *const frame, size_t const channels,
+                           float const level, uint8_t const care,
+                           uint8_t const value) {
+  uint8_t bits = 0;
+  for (size_t ch = 0; ch < channels; ch++) {
+    bits |= (uint8_t)((frame[ch] >= level) << ch);
+  }
+  return (bits & care) == (value & care);
+}
+
+/*
+ * Index of the first frame whose pattern match differs from matched. With 1,
+ * 2 or 4 channels one vector compare thresholds 4 / channels frames.
+ */
+static size_t findPatternChange(float const *const src,
+                                size_t const channels, size_t i,
+                                size_t const count, float const level,
+                                uint8_t const care, uint8_t const value,
+                                bool const matched) {
+#if defined(__SSE__)
+  if (channels == 1 || channels == 2 || channels == 4) {
+    size_t const framesPerVector = 4 / channels;
+    uint8_t const frameMask = (1u << channels) - 1;
+    __m128 const vLevel = _mm_set1_ps(level);
+    for (; i + framesPerVector <= count; i += framesPerVector) {
+      __m128 const v = _mm_loadu_ps(&src[i * channels]);
+      int const bits = _mm_movemask_ps(_mm_cmpge_ps(v, vLevel));
+      for (size_t f = 0; f < framesPerVector; f++) {
+        uint8_t const frameBits = (bits >> (f * channels)) & frameMask;
+        if (((frameBits & care) == (value & care)) != matched) {
+          return i + f;
+        }
+      }
+    }
+  }
+#endif
+  for (; i < count; i++) {
+    if (patternMatches(&src[i * channels], channels, level, care, value) !=
+        matched) {
+      return i;
+    }
+  }
+  return count;
+}
+
+/*
+ * Index of the first of values[i * stride], i in [i, count), that is below
+ * low or above high, count if none. Contiguous and I/Q interleaved channels
+ * are compared four frames at a time.
+ */
+static size_t findOutside(float const *const src, size_t const stride,
+                          size_t i, size_t const count, float const low,
+                          float const high) {
+#if defined(__SSE__)
+  if (stride <= 2) {
+    __m128 const vLow = _mm_set1_ps(low);
+    __m128 const vHigh = _mm_set1_ps(high);
+    for (; i + 4 <= count; i += 4) {
+      __m128 v;
+      if (stride == 1) {
+        v = _mm_loadu_ps(&src[i]);
+      } else {
+        // The second load starts one value early so that it never reads
+        // past the last frame when src points at channel 1.
+        __m128 const a = _mm_loadu_ps(&src[2 * i]);
+        __m128 const b = _mm_loadu_ps(&src[2 * i + 3]);
+        v = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 2, 0));
+      }
+      int const mask = _mm_movemask_ps(
+          _mm_or_ps(_mm_cmplt_ps(v, vLow), _mm_cmpgt_ps(v, vHigh)));
+      if (mask) {
+        return i + __builtin_ctz(mask);
+      }
+    }
+  }
+#endif
+  for (; i < count; i++) {
+    float const v = src[i * stride];
+    if (v < low || v > high) {
+      return i;
+    }
+  }
+  return count;
+}
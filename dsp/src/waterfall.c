@@ -0,0 +1,160 @@
+
+#include "dsp/waterfall.h"
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#define dassert(exp) assert(exp)
+
+typedef struct {
+  float at;
+  uint8_t rgb[3];
+} PaletteStop;
+
+static void buildPalette(Waterfall *const self);
+static void toIndices(float const *const db, size_t const count,
+                      float const scale, float const offset,
+                      int32_t *const indices);
+static void fillRows(Waterfall *const self);
+
+Waterfall *Waterfall_create(size_t const width, size_t const rows) {
+  dassert(width > 0 && rows > 0);
+  Waterfall *self = calloc(1, sizeof(Waterfall));
+  if (!self) {
+    return NULL;
+  }
+  self->width = width;
+  self->rows = rows;
+  self->pixels = calloc(width * rows, 4);
+  self->indices = calloc(width, sizeof(int32_t));
+  if (!self->pixels || !self->indices) {
+    free(self->pixels);
+    free(self->indices);
+    free(self);
+    return NULL;
+  }
+  buildPalette(self);
+  fillRows(self);
+  pthread_mutex_init(&self->mutex, NULL);
+  return self;
+}
+
+void Waterfall_destroy(Waterfall *self) {
+  if (!self) {
+    return;
+  }
+  free(self->pixels);
+  free(self->indices);
+  pthread_mutex_destroy(&self->mutex);
+  free(self);
+  return;
+}
+
+void Waterfall_clear(Waterfall *const self) {
+  pthread_mutex_lock(&self->mutex);
+  fillRows(self);
+  // Every row changed, readers fetch the whole ring again.
+  self->written += self->rows;
+  pthread_mutex_unlock(&self->mutex);
+  return;
+}
+
+void Waterfall_push(Waterfall *const self, float const *const db,
+                    float const dbMin, float const dbMax) {
+  dassert(dbMax > dbMin);
+  size_t const width = self->width;
+  float const scale = (WATERFALL_PALETTE_SIZE - 1) / (dbMax - dbMin);
+  pthread_mutex_lock(&self->mutex);
+  toIndices(db, width, scale, -dbMin * scale, self->indices);
+  size_t const row = self->rows - 1 - self->written % self->rows;
+  uint8_t *const line = self->pixels + row * width * 4;
+  for (size_t x = 0; x < width; x++) {
+    memcpy(line + x * 4, self->palette[self->indices[x]], 4);
+  }
+  self->written++;
+  pthread_mutex_unlock(&self->mutex);
+  return;
+}
+
+bool Waterfall_fetch(Waterfall *const self, uint64_t *const seen,
+                     uint8_t *const rgba, size_t *const row) {
+  pthread_mutex_lock(&self->mutex);
+  uint64_t const written = self->written;
+  if (*seen >= written) {
+    pthread_mutex_unlock(&self->mutex);
+    return false;
+  }
+  if (written - *seen > self->rows) {
+    *seen = written - self->rows;
+  }
+  *row = self->rows - 1 - *seen % self->rows;
+  memcpy(rgba, self->pixels + *row * self->width * 4, self->width * 4);
+  (*seen)++;
+  pthread_mutex_unlock(&self->mutex);
+  return true;
+}
+
+static void buildPalette(Waterfall *const self) {
+  // Noise floor stays dark, strong signals turn hot.
+  static PaletteStop const stops[] = {
+      {0.00f, {0, 0, 0}},     {0.30f, {0, 0, 160}},   {0.55f, {0, 200, 255}},
+      {0.75f, {255, 220, 0}}, {0.90f, {255, 32, 0}},  {1.00f, {255, 255, 255}},
+  };
+  size_t const stopCount = sizeof(stops) / sizeof(stops[0]);
+  for (size_t i = 0; i < WATERFALL_PALETTE_SIZE; i++) {
+    float const at = i / (float)(WATERFALL_PALETTE_SIZE - 1);
+    size_t s = 1;
+    while (s < stopCount - 1 && stops[s].at < at) {
+      s++;
+    }
+    PaletteStop const *const a = &stops[s - 1];
+    PaletteStop const *const b = &stops[s];
+    float t = (at - a->at) / (b->at - a->at);
+    t = (t < 0) ? 0 : (t > 1) ? 1 : t;
+    for (size_t c = 0; c < 3; c++) {
+      self->palette[i][c] =
+          (uint8_t)(a->rgb[c] + t * (b->rgb[c] - a->rgb[c]) + 0.5f);
+    }
+    self->palette[i][3] = 255;
+  }
+  return;
+}
+
+/* Palette index of each level, clamped to the palette. */
+static void toIndices(float const *const db, size_t const count,
+                      float const scale, float const offset,
+                      int32_t *const indices) {
+  float const top = WATERFALL_PALETTE_SIZE - 1;
+  size_t i = 0;
+#if defined(__SSE2__)
+  __m128 const s = _mm_set1_ps(scale);
+  __m128 const o = _mm_set1_ps(offset);
+  __m128 const zero = _mm_setzero_ps();
+  __m128 const t = _mm_set1_ps(top);
+  for (; i + 4 <= count; i += 4) {
+    __m128 v = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(db + i), s), o);
+    // max with NaN as first operand returns zero.
+    v = _mm_min_ps(_mm_max_ps(v, zero), t);
+    _mm_storeu_si128((__m128i *)(indices + i), _mm_cvttps_epi32(v));
+  }
+#endif
+  for (; i < count; i++) {
+    float v = db[i] * scale + offset;
+    v = (v > 0) ? v : 0;
+    v = (v < top) ? v : top;
+    indices[i] = (int32_t)v;
+  }
+  return;
+}
+
+/* Paints every row with the lowest palette entry. */
+static void fillRows(Waterfall *const self) {
+  size_t const count = self->width * self->rows;
+  for (size_t i = 0; i < count; i++) {
+    memcpy(self->pixels + i * 4, self->palette[0], 4);
+  }
+  return;
+}
@@ -0,0 +1,197 @@
+
+#include "dsp/waveform_average.h"
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#endif
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#define dassert(exp) assert(exp)
+
+static void release(WaveformAverage *const self);
+static bool allocate(WaveformAverage *const self, size_t const samples);
+static void addExponential(WaveformAverage *const self,
+                           float const *const src);
+static void addBoxcar(WaveformAverage *const self, float const *const src);
+
+WaveformAverage *WaveformAverage_create(void) {
+  WaveformAverage *self = calloc(1, sizeof(WaveformAverage));
+  if (!self) {
+    return NULL;
+  }
+  self->mode = WAVEFORM_AVERAGE_OFF;
+  self->count = 1;
+  pthread_mutex_init(&self->mutex, NULL);
+  return self;
+}
+
+void WaveformAverage_destroy(WaveformAverage *self) {
+  if (!self) {
+    return;
+  }
+  release(self);
+  pthread_mutex_destroy(&self->mutex);
+  free(self);
+  return;
+}
+
+void WaveformAverage_reset(WaveformAverage *const self) {
+  pthread_mutex_lock(&self->mutex);
+  self->acquired = 0;
+  self->next = 0;
+  pthread_mutex_unlock(&self->mutex);
+  return;
+}
+
+void WaveformAverage_configure(WaveformAverage *const self, int const mode,
+                               size_t const count) {
+  dassert(count >= 1 && count <= WAVEFORM_AVERAGE_MAX_COUNT);
+  pthread_mutex_lock(&self->mutex);
+  if (mode != self->mode || count != self->count) {
+    // The boxcar history depends on both, allocated on the next waveform.
+    release(self);
+    self->mode = mode;
+    self->count = count;
+  }
+  pthread_mutex_unlock(&self->mutex);
+  return;
+}
+
+bool WaveformAverage_add(WaveformAverage *const self, float const *const src,
+                         size_t const samples) {
+  dassert(samples > 0);
+  pthread_mutex_lock(&self->mutex);
+  bool const ready = self->mode != WAVEFORM_AVERAGE_OFF &&
+                     (samples == self->samples || allocate(self, samples));
+  if (ready && self->acquired == 0) {
+    memcpy(self->mean, src, samples * sizeof(float));
+    if (self->mode == WAVEFORM_AVERAGE_BOXCAR) {
+      for (size_t i = 0; i < samples; i++) {
+        self->sum[i] = src[i];
+      }
+      memcpy(self->history, src, samples * sizeof(float));
+      self->next = 1 % self->count;
+    }
+    self->acquired = 1;
+  } else if (ready) {
+    if (self->mode == WAVEFORM_AVERAGE_BOXCAR) {
+      addBoxcar(self, src);
+    } else {
+      addExponential(self, src);
+    }
+    self->acquired++;
+  }
+  pthread_mutex_unlock(&self->mutex);
+  return ready;
+}
+
+size_t WaveformAverage_read(WaveformAverage *const self, float *const dst,
+                            size_t const maxSamples, size_t *const acquired) {
+  pthread_mutex_lock(&self->mutex);
+  size_t const samples =
+      (self->acquired && self->samples <= maxSamples) ? self->samples : 0;
+  memcpy(dst, self->mean, samples * sizeof(float));
+  *acquired = self->acquired;
+  pthread_mutex_unlock(&self->mutex);
+  return samples;
+}
+
+/* Frees the accumulators, the next waveform allocates them again. */
+static void release(WaveformAverage *const self) {
+  free(self->mean);
+  free(self->sum);
+  free(self->history);
+  self->mean = NULL;
+  self->sum = NULL;
+  self->history = NULL;
+  self->samples = 0;
+  self->acquired = 0;
+  self->next = 0;
+  return;
+}
+
+/* Allocates the accumulators of the current mode for samples long
+ * waveforms. */
+static bool allocate(WaveformAverage *const self, size_t const samples) {
+  release(self);
+  bool const boxcar = self->mode == WAVEFORM_AVERAGE_BOXCAR;
+  if (boxcar && samples > WAVEFORM_AVERAGE_MAX_HISTORY / self->count) {
+    return false;
+  }
+  self->mean = calloc(samples, sizeof(float));
+  if (boxcar) {
+    self->sum = calloc(samples, sizeof(double));
+    self->history = calloc(samples * self->count, sizeof(float));
+  }
+  if (!self->mean || (boxcar && (!self->sum || !self->history))) {
+    release(self);
+    return false;
+  }
+  self->samples = samples;
+  return true;
+}
+
+/* mean += (src - mean) / n, n growing up to count so that the first
+ * waveforms are not biased towards the first one. */
+static void addExponential(WaveformAverage *const self,
+                           float const *const src) {
+  size_t const n =
+      (self->acquired + 1 < self->count) ? self->acquired + 1 : self->count;
+  float const weight = 1.0f / n;
+  float *const mean = self->mean;
+  size_t i = 0;
+#if defined(__SSE__)
+  __m128 const vWeight = _mm_set1_ps(weight);
+  for (; i + 4 <= self->samples; i += 4) {
+    __m128 const m = _mm_loadu_ps(&mean[i]);
+    __m128 const delta = _mm_sub_ps(_mm_loadu_ps(&src[i]), m);
+    _mm_storeu_ps(&mean[i], _mm_add_ps(m, _mm_mul_ps(delta, vWeight)));
+  }
+#endif
+  for (; i < self->samples; i++) {
+    mean[i] += (src[i] - mean[i]) * weight;
+  }
+  return;
+}
+
+/* The oldest waveform of a full ring leaves the sum as src enters it. Sums
+ * are kept in double so that the running difference does not drift. */
+static void addBoxcar(WaveformAverage *const self, float const *const src) {
+  bool const full = self->acquired >= self->count;
+  size_t const n = (full) ? self->count : self->acquired + 1;
+  float *const slot = self->history + self->next * self->samples;
+  double *const sum = self->sum;
+  float *const mean = self->mean;
+  double const scale = 1.0 / n;
+  size_t i = 0;
+#if defined(__SSE2__)
+  __m128d const vScale = _mm_set1_pd(scale);
+  for (; i + 4 <= self->samples; i += 4) {
+    __m128 const x = _mm_loadu_ps(&src[i]);
+    __m128 const old = (full) ? _mm_loadu_ps(&slot[i]) : _mm_setzero_ps();
+    __m128d lo = _mm_sub_pd(_mm_cvtps_pd(x), _mm_cvtps_pd(old));
+    __m128d hi = _mm_sub_pd(_mm_cvtps_pd(_mm_movehl_ps(x, x)),
+                            _mm_cvtps_pd(_mm_movehl_ps(old, old)));
+    lo = _mm_add_pd(_mm_loadu_pd(&sum[i]), lo);
+    hi = _mm_add_pd(_mm_loadu_pd(&sum[i + 2]), hi);
+    _mm_storeu_pd(&sum[i], lo);
+    _mm_storeu_pd(&sum[i + 2], hi);
+    __m128 const m = _mm_movelh_ps(_mm_cvtpd_ps(_mm_mul_pd(lo, vScale)),
+                                   _mm_cvtpd_ps(_mm_mul_pd(hi, vScale)));
+    _mm_storeu_ps(&mean[i], m);
+    _mm_storeu_ps(&slot[i], x);
+  }
+#endif
+  for (; i < self->samples; i++) {
+    double const old = (full) ? slot[i] : 0;
+    sum[i] += (double)src[i] - old;
+    mean[i] = (float)(sum[i] * scale);
+    slot[i] = src[i];
+  }
+  self->next = (self->next + 1) % self->count;
+  return;
+}
@@ -0,0 +1,41 @@
+
+#include "dsp/autoset.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define CHUNK 1000
+#define PERIOD 123.4
+
+int main(void) {
+  static float chunk[CHUNK * 2];
+  double const pi = acos(-1);
+  AutosetEstimate estimate;
+  int failures = 0;
+  Autoset *autoset = Autoset_create();
+  if (Autoset_estimate(autoset, &estimate)) {
+    printf("estimate without samples\n");
+    failures++;
+  }
+  // A noisy offset tone on the first channel, the second one is ignored.
+  srand(1);
+  size_t n = 0;
+  for (int c = 0; c < 200; c++) {
+    for (size_t i = 0; i < CHUNK; i++, n++) {
+      float const noise = 0.05f * (rand() / (float)RAND_MAX - 0.5f);
+      chunk[2 * i] = 0.3f + 0.7f * (float)sin(2 * pi * n / PERIOD) + noise;
+      chunk[2 * i + 1] = 9;
+    }
+    Autoset_process(autoset, chunk, CHUNK, 2);
+  }
+  if (!Autoset_estimate(autoset, &estimate) ||
+      fabsf(estimate.min + 0.4f) > 0.05f ||
+      fabsf(estimate.max - 1.0f) > 0.05f ||
+      fabs(estimate.period - PERIOD) > 0.5) {
+    printf("min %g max %g period %g\n", estimate.min, estimate.max,
+           estimate.period);
+    failures++;
+  }
+  Autoset_destroy(autoset);
+  return (failures) ? 1 : 0;
+}
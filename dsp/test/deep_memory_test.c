@@ -0,0 +1,72 @@
+
+#include "dsp/decimate.h"
+#include "dsp/deep_memory.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define CHUNK 1000
+#define COLUMNS 100
+
+int main(void) {
+  int failures = 0;
+  DeepMemory *memory = DeepMemory_create(64 * 1024 * sizeof(float), 1);
+  size_t const capacity = memory->capacity;
+  float *chunk = calloc(CHUNK, sizeof(float));
+  float *copy = calloc(capacity, sizeof(float));
+  float reducedMin[COLUMNS], reducedMax[COLUMNS];
+  float expectedMin[COLUMNS], expectedMax[COLUMNS];
+  // Frame k holds k: two and a half times the capacity, so the ring wraps.
+  uint64_t written = 0;
+  while (written < capacity * 5 / 2) {
+    for (size_t i = 0; i < CHUNK; i++) {
+      chunk[i] = (float)(written + i);
+    }
+    DeepMemory_write(memory, chunk, CHUNK);
+    written += CHUNK;
+  }
+  uint64_t oldest;
+  uint64_t const newest = DeepMemory_range(memory, &oldest);
+  if (newest != written || newest - oldest != capacity) {
+    printf("range %llu..%llu\n", (unsigned long long)oldest,
+           (unsigned long long)newest);
+    failures++;
+  }
+  // The whole stored range, across the wrap.
+  if (!DeepMemory_copy(memory, oldest, capacity, copy) ||
+      copy[0] != (float)oldest || copy[capacity - 1] != (float)(newest - 1)) {
+    printf("copy %g..%g\n", copy[0], copy[capacity - 1]);
+    failures++;
+  }
+  // Overwritten or not yet written frames are refused, dst left untouched.
+  copy[0] = -1;
+  if (DeepMemory_copy(memory, oldest - 1, 16, copy) ||
+      DeepMemory_copy(memory, newest - 15, 16, copy) || copy[0] != -1) {
+    printf("copy outside of the stored range\n");
+    failures++;
+  }
+  // The pyramid walk matches a reduction of the raw frames.
+  DeepMemory_copy(memory, oldest, capacity, copy);
+  Decimate_minMax(copy, capacity, 1, COLUMNS, expectedMin, expectedMax);
+  if (!DeepMemory_reduce(memory, oldest, capacity, COLUMNS, reducedMin,
+                         reducedMax)) {
+    printf("reduce failed\n");
+    failures++;
+  }
+  for (size_t c = 0; c < COLUMNS; c++) {
+    if (reducedMin[c] != expectedMin[c] || reducedMax[c] != expectedMax[c]) {
+      printf("column %zu: %g %g, expected %g %g\n", c, reducedMin[c],
+             reducedMax[c], expectedMin[c], expectedMax[c]);
+      failures++;
+      break;
+    }
+  }
+  if (DeepMemory_reduce(memory, oldest - 1, capacity, COLUMNS, reducedMin,
+                        reducedMax)) {
+    printf("reduce outside of the stored range\n");
+    failures++;
+  }
+  free(copy);
+  free(chunk);
+  DeepMemory_destroy(memory);
+  return (failures) ? 1 : 0;
+}
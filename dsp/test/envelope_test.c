@@ -0,0 +1,56 @@
+
+#include "dsp/envelope.h"
+#include <math.h>
+#include <stdio.h>
+
+#define COLUMNS 10
+#define FRAMES 37
+
+int main(void) {
+  float waveform[FRAMES * 2];
+  float lower[COLUMNS * 2], upper[COLUMNS * 2];
+  float lowerFrames[FRAMES], upperFrames[FRAMES];
+  size_t acquired;
+  int failures = 0;
+  // Channel 0 holds k + i / 100 and channel 1 its opposite, k = 0..4.
+  Envelope *envelope = Envelope_create(COLUMNS, 2);
+  for (int k = 0; k < 5; k++) {
+    for (size_t i = 0; i < FRAMES; i++) {
+      waveform[2 * i] = k + i * 0.01f;
+      waveform[2 * i + 1] = -waveform[2 * i];
+    }
+    Envelope_add(envelope, waveform, FRAMES);
+  }
+  // Reduced: column 0 covers frames 0 to 2.
+  size_t points = Envelope_read(envelope, lower, upper, &acquired);
+  if (points != COLUMNS || acquired != 5 || fabsf(lower[0]) > 1e-6f ||
+      fabsf(upper[0] - 4.02f) > 1e-5f || fabsf(lower[1] + 4.02f) > 1e-5f ||
+      fabsf(upper[1]) > 1e-6f) {
+    printf("reduced envelope %zu points, %g %g %g %g\n", points, lower[0],
+           upper[0], lower[1], upper[1]);
+    failures++;
+  }
+  Envelope_destroy(envelope);
+  // One point per frame when the waveform fits the columns.
+  envelope = Envelope_create(FRAMES, 1);
+  for (int k = 0; k < 3; k++) {
+    for (size_t i = 0; i < FRAMES; i++) {
+      waveform[i] = (float)k - i;
+    }
+    Envelope_add(envelope, waveform, FRAMES);
+  }
+  points = Envelope_read(envelope, lowerFrames, upperFrames, &acquired);
+  if (points != FRAMES || lowerFrames[FRAMES - 1] != -36.0f ||
+      upperFrames[FRAMES - 1] != -34.0f) {
+    printf("envelope %zu points, %g %g\n", points, lowerFrames[FRAMES - 1],
+           upperFrames[FRAMES - 1]);
+    failures++;
+  }
+  Envelope_reset(envelope);
+  if (Envelope_read(envelope, lowerFrames, upperFrames, &acquired) != 0) {
+    printf("reset envelope not empty\n");
+    failures++;
+  }
+  Envelope_destroy(envelope);
+  return (failures) ? 1 : 0;
+}
@@ -0,0 +1,75 @@
+
+#include "dsp/fft.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define MAX_SIZE 4096
+// Error bound relative to sqrt(size), the growth of a random input spectrum.
+#define TOLERANCE 1e-6
+
+static double dftError(float const *const xRe, float const *const xIm,
+                       size_t const size, float const *const re,
+                       float const *const im, size_t const bins);
+
+int main(void) {
+  static float xRe[MAX_SIZE], xIm[MAX_SIZE], re[MAX_SIZE], im[MAX_SIZE];
+  static float zero[MAX_SIZE];
+  int failures = 0;
+  srand(1);
+  for (size_t i = 0; i < MAX_SIZE; i++) {
+    xRe[i] = rand() / (float)RAND_MAX - 0.5f;
+    xIm[i] = rand() / (float)RAND_MAX - 0.5f;
+  }
+  // Every size, so that both the radix-4 and the trailing radix-2 passes
+  // are covered.
+  for (size_t size = 2; size <= MAX_SIZE; size *= 2) {
+    FftPlan *plan = FftPlan_create(size);
+    for (size_t i = 0; i < size; i++) {
+      re[i] = xRe[i];
+      im[i] = xIm[i];
+    }
+    FftPlan_forward(plan, re, im);
+    double const error = dftError(xRe, xIm, size, re, im, size);
+    if (error > TOLERANCE) {
+      printf("complex FFT %zu: error %g\n", size, error);
+      failures++;
+    }
+    FftPlan_destroy(plan);
+  }
+  for (size_t size = 4; size <= MAX_SIZE; size *= 2) {
+    RealFftPlan *plan = RealFftPlan_create(size);
+    RealFftPlan_forward(plan, xRe, re, im);
+    double const error = dftError(xRe, zero, size, re, im, size / 2 + 1);
+    if (error > TOLERANCE) {
+      printf("real FFT %zu: error %g\n", size, error);
+      failures++;
+    }
+    RealFftPlan_destroy(plan);
+  }
+  if (FftPlan_create(3) || RealFftPlan_create(2)) {
+    printf("invalid sizes accepted\n");
+    failures++;
+  }
+  return (failures) ? 1 : 0;
+}
+
+/* Largest difference to a double precision DFT over the first bins. */
+static double dftError(float const *const xRe, float const *const xIm,
+                       size_t const size, float const *const re,
+                       float const *const im, size_t const bins) {
+  double const pi = acos(-1);
+  double error = 0;
+  for (size_t k = 0; k < bins; k++) {
+    double sumRe = 0;
+    double sumIm = 0;
+    for (size_t n = 0; n < size; n++) {
+      double const angle = -2 * pi * (double)((n * k) % size) / size;
+      sumRe += xRe[n] * cos(angle) - xIm[n] * sin(angle);
+      sumIm += xRe[n] * sin(angle) + xIm[n] * cos(angle);
+    }
+    error = fmax(error, fabs(re[k] - sumRe));
+    error = fmax(error, fabs(im[k] - sumIm));
+  }
+  return error / sqrt((double)size);
+}
@@ -0,0 +1,47 @@
+
+#include "dsp/interpolate.h"
+#include <math.h>
+#include <stdio.h>
+
+#define FRAMES 64
+#define POINTS 8
+#define FIRST 16 // Leaves half the taps of context on both sides.
+#define COUNT 32
+
+int main(void) {
+  static float src[FRAMES * 2];
+  static float dst[((COUNT - 1) * POINTS + 1) * 2];
+  double const pi = acos(-1);
+  int failures = 0;
+  // A tone close to Nyquist on one channel, a slow one on the other.
+  for (size_t i = 0; i < FRAMES; i++) {
+    src[2 * i] = (float)sin(2 * pi * 0.4 * i + 0.3);
+    src[2 * i + 1] = (float)cos(2 * pi * 0.1 * i);
+  }
+  Interpolator *interpolator = Interpolator_create(POINTS, FRAMES);
+  size_t const values =
+      Interpolator_run(interpolator, src, FRAMES, 2, FIRST, COUNT, dst);
+  if (values != (COUNT - 1) * POINTS + 1) {
+    printf("%zu values per channel\n", values);
+    return 1;
+  }
+  double error = 0;
+  for (size_t j = 0; j < values; j++) {
+    double const x = FIRST + j / (double)POINTS;
+    error = fmax(error, fabs(dst[j] - sin(2 * pi * 0.4 * x + 0.3)));
+    error = fmax(error, fabs(dst[values + j] - cos(2 * pi * 0.1 * x)));
+  }
+  if (error > 0.01) {
+    printf("interpolation error %g\n", error);
+    failures++;
+  }
+  // Every POINTS-th value is an input sample.
+  for (size_t i = 0; i < COUNT; i++) {
+    if (fabsf(dst[i * POINTS] - src[2 * (FIRST + i)]) > 1e-5f) {
+      printf("sample %zu moved\n", FIRST + i);
+      failures++;
+    }
+  }
+  Interpolator_destroy(interpolator);
+  return (failures) ? 1 : 0;
+}
@@ -0,0 +1,50 @@
+
+#include "dsp/segments.h"
+#include <stdio.h>
+
+#define COUNT 3
+#define FRAMES 4
+
+int main(void) {
+  float window[FRAMES * 2];
+  SegmentStamp stamp;
+  int failures = 0;
+  Segments *segments = Segments_create(2);
+  if (!Segments_arm(segments, COUNT, FRAMES)) {
+    printf("arm failed\n");
+    return 1;
+  }
+  // Windows past the last segment are dropped.
+  for (int k = 0; k < COUNT + 2; k++) {
+    for (size_t i = 0; i < FRAMES * 2; i++) {
+      window[i] = k * 10.0f + i;
+    }
+    size_t const left = Segments_store(segments, window, FRAMES, 100 + k);
+    size_t const expected = (k < COUNT) ? COUNT - 1 - k : 0;
+    if (left != expected) {
+      printf("%zu segments left after %d\n", left, k);
+      failures++;
+    }
+  }
+  if (Segments_filled(segments) != COUNT ||
+      !Segments_read(segments, 2, window, &stamp) || window[0] != 20 ||
+      window[FRAMES * 2 - 1] != 27 || stamp.trigger != 102) {
+    printf("segment 2 holds %g..%g, trigger %llu\n", window[0],
+           window[FRAMES * 2 - 1], (unsigned long long)stamp.trigger);
+    failures++;
+  }
+  // Mismatching windows are dropped, re-arming empties the segments.
+  Segments_arm(segments, COUNT, FRAMES);
+  Segments_store(segments, window, FRAMES - 1, 0);
+  if (Segments_filled(segments) != 0 ||
+      Segments_read(segments, 0, NULL, NULL)) {
+    printf("re-armed segments not empty\n");
+    failures++;
+  }
+  if (Segments_arm(segments, SEGMENTS_MAX_COUNT, SEGMENTS_MAX_SAMPLES)) {
+    printf("oversized segments armed\n");
+    failures++;
+  }
+  Segments_destroy(segments);
+  return (failures) ? 1 : 0;
+}
@@ -0,0 +1,64 @@
+
+#include "dsp/spectrum.h"
+#include <math.h>
+#include <stdio.h>
+
+#define SIZE 1024
+#define BINS (SIZE / 2 + 1)
+#define TONE_BIN 64
+
+static void feed(Spectrum *const self, float const amplitude);
+
+int main(void) {
+  static float db[BINS];
+  int failures = 0;
+  // A full scale tone reads 0 dB in its bin, whatever the window.
+  Spectrum *spectrum = Spectrum_create(false);
+  for (int window = SPECTRUM_WINDOW_HANN; window <= SPECTRUM_WINDOW_FLAT_TOP;
+       window++) {
+    Spectrum_configure(spectrum, SIZE, window, SPECTRUM_AVERAGE_NONE, 1);
+    Spectrum_reset(spectrum);
+    feed(spectrum, 1);
+    Spectrum_read(spectrum, BINS, db);
+    size_t peak = 0;
+    for (size_t b = 0; b < BINS; b++) {
+      peak = (db[b] > db[peak]) ? b : peak;
+    }
+    if (peak != TONE_BIN || fabsf(db[peak]) > 0.1f) {
+      printf("window %d: peak %g dB in bin %zu\n", window, db[peak], peak);
+      failures++;
+    }
+  }
+  // LINEAR is the power mean until averages spectra are in.
+  Spectrum_configure(spectrum, SIZE, SPECTRUM_WINDOW_HANN,
+                     SPECTRUM_AVERAGE_LINEAR, 4);
+  Spectrum_reset(spectrum);
+  feed(spectrum, 1);
+  feed(spectrum, 0.5f);
+  Spectrum_read(spectrum, BINS, db);
+  float const expected = 10 * log10f((1 + 0.25f) / 2);
+  if (fabsf(db[TONE_BIN] - expected) > 0.1f) {
+    printf("linear average %g dB, expected %g dB\n", db[TONE_BIN], expected);
+    failures++;
+  }
+  Spectrum_destroy(spectrum);
+  return (failures) ? 1 : 0;
+}
+
+/* One block of a tone centered on TONE_BIN. */
+static void feed(Spectrum *const self, float const amplitude) {
+  float block[SIZE];
+  double const pi = acos(-1);
+  for (size_t i = 0; i < SIZE; i++) {
+    block[i] = amplitude * (float)cos(2 * pi * TONE_BIN * i / SIZE);
+  }
+  size_t done = 0;
+  while (done < SIZE) {
+    size_t consumed;
+    bool transformed;
+    Spectrum_process(self, block + done, SIZE - done, 1, &consumed,
+                     &transformed);
+    done += consumed;
+  }
+  return;
+}
@@ -0,0 +1,56 @@
+
+#include "dsp/waveform_average.h"
+#include <math.h>
+#include <stdio.h>
+
+#define SAMPLES 103 // Not a multiple of the vector width.
+#define COUNT 4
+
+int main(void) {
+  float waveform[SAMPLES];
+  float mean[SAMPLES];
+  size_t acquired;
+  int failures = 0;
+  WaveformAverage *average = WaveformAverage_create();
+  // Waveforms k = 0..9 hold k + i / 100: the boxcar keeps the last COUNT.
+  WaveformAverage_configure(average, WAVEFORM_AVERAGE_BOXCAR, COUNT);
+  for (int k = 0; k < 10; k++) {
+    for (size_t i = 0; i < SAMPLES; i++) {
+      waveform[i] = k + i * 0.01f;
+    }
+    WaveformAverage_add(average, waveform, SAMPLES);
+  }
+  size_t samples =
+      WaveformAverage_read(average, mean, SAMPLES, &acquired);
+  for (size_t i = 0; i < samples; i++) {
+    if (fabsf(mean[i] - (7.5f + i * 0.01f)) > 1e-4f) {
+      printf("boxcar mean %g at %zu\n", mean[i], i);
+      failures++;
+      break;
+    }
+  }
+  if (samples != SAMPLES || acquired != 10) {
+    printf("boxcar read %zu samples of %zu waveforms\n", samples, acquired);
+    failures++;
+  }
+  // The exponential mean is exact over its first COUNT waveforms.
+  WaveformAverage_configure(average, WAVEFORM_AVERAGE_EXPONENTIAL, COUNT);
+  for (int k = 0; k < COUNT; k++) {
+    for (size_t i = 0; i < SAMPLES; i++) {
+      waveform[i] = (float)k;
+    }
+    WaveformAverage_add(average, waveform, SAMPLES);
+  }
+  WaveformAverage_read(average, mean, SAMPLES, &acquired);
+  if (fabsf(mean[SAMPLES - 1] - 1.5f) > 1e-5f) {
+    printf("exponential mean %g\n", mean[SAMPLES - 1]);
+    failures++;
+  }
+  // Too small a destination reads nothing.
+  if (WaveformAverage_read(average, mean, SAMPLES - 1, &acquired) != 0) {
+    printf("read overflowed\n");
+    failures++;
+  }
+  WaveformAverage_destroy(average);
+  return (failures) ? 1 : 0;
+}
@@ -0,0 +1,44 @@
+
+#pragma once
+
+#include "buffer/io_buffer.h"
+#include "ingest/shm_ring.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef struct {
+  ShmRingHeader *ring;
+  size_t mapSize;
+  size_t dataSize; // Storage size checked against mapSize at attach.
+} ShmIngest;
+
+/* ============================================ Public functions declaration */
+
+/**
+ * @brief Attaches to a shared-memory ring created by a producer. Allocates
+ * memory that must be freed with ShmIngest_detach.
+ *
+ * @param[in] name: POSIX shm name of the segment, e.g. "/scope".
+ * @return ShmIngest instance, NULL if the segment does not exist (yet) or is
+ * not a valid ring.
+ */
+ShmIngest *ShmIngest_attach(char const *const name);
+
+/**
+ * @brief Unmaps the segment and frees the instance.
+ *
+ * @param[in] self: ShmIngest instance.
+ */
+void ShmIngest_detach(ShmIngest *self);
+
+/**
+ * @brief Moves all available data from the shared ring into dst, copying
+ * straight from the mapped segment. Does not block execution flow.
+ *
+ * @param[in] self: ShmIngest instance.
+ * @param[in] dst: IOBuffer to fill.
+ * @return Number of bytes moved in result. errorCode is BUFFER_ERROR_EMPTY if
+ * there was nothing to move, BUFFER_ERROR_EOF if the producer closed the ring
+ * and it has been drained or if the ring positions are out of bounds.
+ */
+BufferError ShmIngest_drain(ShmIngest *const self, IOBuffer *const dst);
@@ -0,0 +1,120 @@
+
+#pragma once
+
+/*
+ * Header-only producer side of the shared-memory transport. Copy this header
+ * together with shm_ring.h and io_buffer.h into the producer project, no
+ * library needs to be linked (except -lrt on old glibc).
+ *
+ *   ShmProducer p;
+ *   if (ShmProducer_open(&p, "/scope", 1 << 20) == 0) {
+ *     ShmProducer_write(&p, samples, sizeof(samples));
+ *     ShmProducer_close(&p, true);
+ *   }
+ */
+
+#include "ingest/shm_ring.h"
+#include <fcntl.h>
+#include <stdbool.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define INLINE static inline
+
+typedef struct {
+  ShmRingHeader *ring;
+  size_t mapSize;
+  char const *name;
+} ShmProducer;
+
+/* ============================================ Public functions declaration */
+
+/**
+ * @brief Creates (or recreates) the named shared-memory segment and
+ * initializes an empty ring in it.
+ *
+ * @param[out] self: ShmProducer instance.
+ * @param[in] name: POSIX shm name, e.g. "/scope". Must outlive the producer.
+ * @param[in] dataSize: Size in bytes of the ring storage.
+ * @return 0 on success, -1 on error (errno is set).
+ */
+INLINE int ShmProducer_open(ShmProducer *const self, char const *const name,
+                            size_t const dataSize);
+
+/**
+ * @brief Writes at most dataSize bytes into the ring. Never blocks and makes
+ * no syscalls, data that does not fit is dropped.
+ *
+ * @param[in] self: ShmProducer instance.
+ * @param[in] dataSrc: Pointer to the samples to write.
+ * @param[in] dataSize: Number of bytes to write.
+ * @return Result of the operation, see ShmRing_write.
+ */
+INLINE BufferError ShmProducer_write(ShmProducer *const self,
+                                     void const *const dataSrc,
+                                     size_t const dataSize);
+
+/**
+ * @brief Signals end of stream to the consumer and unmaps the segment.
+ *
+ * @param[in] self: ShmProducer instance.
+ * @param[in] unlink: Also remove the segment name from the system.
+ */
+INLINE void ShmProducer_close(ShmProducer *const self, bool const unlink);
+
+/* ============================================== Public functions definition*/
+
+INLINE int ShmProducer_open(ShmProducer *const self, char const *const name,
+                            size_t const dataSize) {
+  self->ring = NULL;
+  self->name = name;
+  self->mapSize = ShmRing_segmentSize(dataSize);
+  shm_unlink(name);
+  int fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0600);
+  if (fd < 0) {
+    return -1;
+  }
+  if (ftruncate(fd, self->mapSize) != 0) {
+    close(fd);
+    shm_unlink(name);
+    return -1;
+  }
+  void *map =
+      mmap(NULL, self->mapSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (map == MAP_FAILED) {
+    shm_unlink(name);
+    return -1;
+  }
+  self->ring = (ShmRingHeader *)map;
+  self->ring->version = SHM_RING_VERSION;
+  self->ring->dataSize = dataSize;
+  self->ring->writePos = 0;
+  self->ring->readPos = 0;
+  self->ring->eof = 0;
+  // Publish the magic last, the consumer only attaches once it is visible.
+  __atomic_store_n(&self->ring->magic, SHM_RING_MAGIC, __ATOMIC_RELEASE);
+  return 0;
+}
+
+INLINE BufferError ShmProducer_write(ShmProducer *const self,
+                                     void const *const dataSrc,
+                                     size_t const dataSize) {
+  return ShmRing_write(self->ring, (uint8_t const *)dataSrc, dataSize);
+}
+
+INLINE void ShmProducer_close(ShmProducer *const self, bool const unlink) {
+  if (!self->ring) {
+    return;
+  }
+  __atomic_store_n(&self->ring->eof, 1, __ATOMIC_RELEASE);
+  munmap(self->ring, self->mapSize);
+  self->ring = NULL;
+  if (unlink) {
+    shm_unlink(self->name);
+  }
+  return;
+}
+
+#undef INLINE
@@ -0,0 +1,168 @@
+
+#pragma once
+
+#include "buffer/io_buffer.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#define INLINE static inline
+
+#define SHM_RING_MAGIC 0x5243534fu /* "OSCR" */
+#define SHM_RING_VERSION 1u
+
+/**
+ * Layout of a shared-memory ring segment. The header is followed by dataSize
+ * bytes of sample storage. Positions are byte offsets into the storage so the
+ * segment can be mapped at different addresses by producer and consumer.
+ * Same full/empty convention as IOBuffer: one byte is always left free.
+ */
+typedef struct {
+  uint32_t magic;
+  uint32_t version;
+  uint64_t dataSize;
+  _Alignas(64) uint64_t writePos; // Owned by the producer.
+  uint32_t eof;
+  _Alignas(64) uint64_t readPos; // Owned by the consumer.
+  _Alignas(64) uint8_t data[];
+} ShmRingHeader;
+
+/* ============================================ Public functions declaration */
+
+/**
+ * @brief Returns the number of bytes needed to map a ring with dataSize bytes
+ * of storage.
+ *
+ * @param[in] dataSize: Size in bytes of the sample storage.
+ * @return Size in bytes of the whole segment.
+ */
+INLINE size_t ShmRing_segmentSize(size_t const dataSize);
+
+/**
+ * @brief Returns size in bytes of available data in the ring.
+ *
+ * @param[in] self: Ring header.
+ * @param[in] dataSize: Storage size known to be mapped, as for ShmRing_peek.
+ * @return Size of available data in bytes, 0 if a position is outside of the
+ * storage.
+ */
+INLINE size_t ShmRing_available(ShmRingHeader const *const self,
+                                size_t const dataSize);
+
+/**
+ * @brief Writes at most dataSize bytes into the ring. Never blocks, data that
+ * does not fit is dropped. Must only be called by the producer.
+ *
+ * @param[in] self: Ring header.
+ * @param[in] dataSrc: Pointer to memory space to copy into the ring.
+ * @param[in] dataSize: Number of bytes to write.
+ * @return Result of the operation. If number of written bytes is different
+ * from dataSize check errorCode in BufferError.
+ */
+INLINE BufferError ShmRing_write(ShmRingHeader *const self,
+                                 uint8_t const *const dataSrc,
+                                 size_t const dataSize);
+
+/**
+ * @brief Returns the readable spans of the ring without consuming them. The
+ * second span is non-empty only when the data wraps around the storage end.
+ * Must only be called by the consumer, release the spans with ShmRing_consume.
+ *
+ * @param[in] self: Ring header.
+ * @param[in] dataSize: Storage size known to be mapped. The header copy is
+ * writable by the producer and is not trusted.
+ * @param[out] span0: First contiguous readable span.
+ * @param[out] span0Size: Size in bytes of the first span.
+ * @param[out] span1: Second contiguous readable span.
+ * @param[out] span1Size: Size in bytes of the second span.
+ * @return false, with empty spans, if a position is outside of the storage.
+ */
+INLINE bool ShmRing_peek(ShmRingHeader const *const self,
+                         size_t const dataSize, uint8_t const **span0,
+                         size_t *span0Size, uint8_t const **span1,
+                         size_t *span1Size);
+
+/**
+ * @brief Releases size bytes previously obtained with ShmRing_peek.
+ *
+ * @param[in] self: Ring header.
+ * @param[in] dataSize: Storage size given to ShmRing_peek.
+ * @param[in] size: Number of bytes to release.
+ */
+INLINE void ShmRing_consume(ShmRingHeader *const self, size_t const dataSize,
+                            size_t const size);
+
+/* ============================================== Public functions definition*/
+
+INLINE size_t ShmRing_segmentSize(size_t const dataSize) {
+  return sizeof(ShmRingHeader) + dataSize;
+}
+
+INLINE size_t ShmRing_available(ShmRingHeader const *const self,
+                                size_t const dataSize) {
+  uint64_t const w = __atomic_load_n(&self->writePos, __ATOMIC_ACQUIRE);
+  uint64_t const r = __atomic_load_n(&self->readPos, __ATOMIC_RELAXED);
+  if (w >= dataSize || r >= dataSize) {
+    return 0;
+  }
+  return (w >= r) ? w - r : dataSize - r + w;
+}
+
+INLINE BufferError ShmRing_write(ShmRingHeader *const self,
+                                 uint8_t const *const dataSrc,
+                                 size_t const dataSize) {
+  BufferError err = {.result = 0, .errorCode = BUFFER_ERROR_OK};
+  uint64_t const size = self->dataSize;
+  if (dataSize > size) {
+    err.errorCode = BUFFER_ERROR_DATA_TOO_BIG;
+    return err;
+  }
+  uint64_t const w = __atomic_load_n(&self->writePos, __ATOMIC_RELAXED);
+  uint64_t const r = __atomic_load_n(&self->readPos, __ATOMIC_ACQUIRE);
+  size_t const space = (r > w) ? r - w - 1 : size - w + r - 1;
+  size_t const toWrite = (dataSize <= space) ? dataSize : space;
+  size_t const first = (toWrite <= size - w) ? toWrite : size - w;
+  memcpy(&self->data[w], dataSrc, first);
+  memcpy(&self->data[0], dataSrc + first, toWrite - first);
+  uint64_t next = w + toWrite;
+  next = (next < size) ? next : next - size;
+  __atomic_store_n(&self->writePos, next, __ATOMIC_RELEASE);
+  err.result = toWrite;
+  err.errorCode =
+      (toWrite == dataSize) ? BUFFER_ERROR_OK : BUFFER_ERROR_DATA_DROPPED;
+  return err;
+}
+
+INLINE bool ShmRing_peek(ShmRingHeader const *const self,
+                         size_t const dataSize, uint8_t const **span0,
+                         size_t *span0Size, uint8_t const **span1,
+                         size_t *span1Size) {
+  uint64_t const w = __atomic_load_n(&self->writePos, __ATOMIC_ACQUIRE);
+  uint64_t const r = __atomic_load_n(&self->readPos, __ATOMIC_RELAXED);
+  *span0 = &self->data[0];
+  *span1 = &self->data[0];
+  *span0Size = 0;
+  *span1Size = 0;
+  if (w >= dataSize || r >= dataSize) {
+    return false;
+  }
+  *span0 = &self->data[r];
+  if (w >= r) {
+    *span0Size = w - r;
+  } else {
+    *span0Size = dataSize - r;
+    *span1Size = w;
+  }
+  return true;
+}
+
+INLINE void ShmRing_consume(ShmRingHeader *const self, size_t const dataSize,
+                            size_t const size) {
+  uint64_t next = __atomic_load_n(&self->readPos, __ATOMIC_RELAXED) + size;
+  next = (next < dataSize) ? next : next - dataSize;
+  __atomic_store_n(&self->readPos, next, __ATOMIC_RELEASE);
+  return;
+}
+
+#undef INLINE
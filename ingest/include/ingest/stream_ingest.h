@@ -0,0 +1,82 @@
+
+#pragma once
+
+#include "buffer/io_buffer.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+
+#define STREAM_INGEST_SCRATCH_SIZE (64 * 1024)
+
+typedef enum {
+  STREAM_FORMAT_F32,  // float32 samples, written to the buffer as is.
+  STREAM_FORMAT_CF32, // Interleaved float32 I/Q pairs.
+  STREAM_FORMAT_S16,  // int16 samples, scaled to [-1, 1).
+  STREAM_FORMAT_CS16, // Interleaved int16 I/Q pairs.
+  STREAM_FORMAT_U8,   // Offset binary uint8 samples, scaled to [-1, 1).
+  STREAM_FORMAT_CU8   // Interleaved uint8 I/Q pairs (rtl_sdr style).
+} StreamFormat;
+
+typedef struct {
+  int fd;
+  StreamFormat format;
+  double sampleRate;
+  uint64_t samplesRead; // Scalar values, two per I/Q pair.
+  struct timespec start;
+  size_t carry; // Bytes of a partial sample left from the previous read.
+  uint8_t *scratch;
+} StreamIngest;
+
+/* ============================================ Public functions declaration */
+
+/**
+ * @brief Parses a format name ("f32", "cf32", "s16", "cs16", "u8", "cu8").
+ *
+ * @param[in] name: Format name.
+ * @param[out] format: Parsed format.
+ * @return true if name is a known format.
+ */
+bool StreamFormat_parse(char const *const name, StreamFormat *const format);
+
+/**
+ * @brief Tells whether the format carries interleaved I/Q pairs.
+ *
+ * @param[in] format: Stream format.
+ * @return true for complex formats.
+ */
+bool StreamFormat_isComplex(StreamFormat const format);
+
+/**
+ * @brief Creates a reader for a pipe, FIFO or regular file. Enlarges the pipe
+ * buffer when fd is a pipe. Allocates memory that must be freed with
+ * StreamIngest_destroy.
+ *
+ * @param[in] fd: Open file descriptor to read from.
+ * @param[in] format: Sample format of the stream.
+ * @param[in] sampleRate: Samples (or I/Q pairs) per second used to pace
+ * reading, 0 reads as fast as the source allows. Useful to replay files.
+ * @return StreamIngest instance, NULL if memory allocation errors.
+ */
+StreamIngest *StreamIngest_create(int const fd, StreamFormat const format,
+                                  double const sampleRate);
+
+/**
+ * @brief Frees the instance. Does not close the file descriptor.
+ *
+ * @param[in] self: StreamIngest instance.
+ */
+void StreamIngest_destroy(StreamIngest *self);
+
+/**
+ * @brief Performs one large read from the stream into dst. float32 formats
+ * are read straight into the buffer's free span, other formats go through a
+ * scratch buffer and are converted to float. Blocks execution flow.
+ *
+ * @param[in] self: StreamIngest instance.
+ * @param[in] dst: IOBuffer to fill.
+ * @return Number of bytes written to dst in result. errorCode is
+ * BUFFER_ERROR_EOF when the stream is over, BUFFER_ERROR_DATA_DROPPED if
+ * dst is full.
+ */
+BufferError StreamIngest_read(StreamIngest *const self, IOBuffer *const dst);
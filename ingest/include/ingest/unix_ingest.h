@@ -0,0 +1,63 @@
+
+#pragma once
+
+#include "buffer/io_buffer.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+struct iovec;
+struct mmsghdr;
+
+#define UNIX_INGEST_MAX_CLIENTS 16
+#define UNIX_INGEST_BATCH 16
+#define UNIX_INGEST_MSG_SIZE (16 * 1024) // Longest message accepted.
+
+typedef struct {
+  int listenFd;
+  int epollFd;
+  int clients[UNIX_INGEST_MAX_CLIENTS];
+  size_t numberClients;
+  uid_t allowedUid;
+  char path[108];
+  uint8_t *batchStorage;
+  struct iovec *iovs;
+  struct mmsghdr *msgs;
+} UnixIngest;
+
+/* ============================================ Public functions declaration */
+
+/**
+ * @brief Creates a SOCK_SEQPACKET listening socket bound to path. Any stale
+ * socket file at path is removed first. Only peers running as the same user
+ * as the scope (or root) are accepted. Allocates memory that must be freed
+ * with UnixIngest_destroy.
+ *
+ * @param[in] path: Filesystem path of the socket.
+ * @return UnixIngest instance, NULL on error (errno is set).
+ */
+UnixIngest *UnixIngest_create(char const *const path);
+
+/**
+ * @brief Closes all connections, removes the socket file and frees the
+ * instance.
+ *
+ * @param[in] self: UnixIngest instance.
+ */
+void UnixIngest_destroy(UnixIngest *self);
+
+/**
+ * @brief Waits for activity on the listening socket or on any producer
+ * connection, accepts new producers and moves all pending messages into dst.
+ * Messages are received in batches of UNIX_INGEST_BATCH per syscall. A
+ * producer sending a message longer than UNIX_INGEST_MSG_SIZE bytes is
+ * disconnected, the part of it that did not fit would be lost.
+ *
+ * @param[in] self: UnixIngest instance.
+ * @param[in] dst: IOBuffer to fill.
+ * @param[in] timeoutMs: Max time to wait in milliseconds, -1 waits forever.
+ * @return Number of bytes written to dst in result. If less data than
+ * received was written check errorCode in BufferError.
+ */
+BufferError UnixIngest_poll(UnixIngest *const self, IOBuffer *const dst,
+                            int const timeoutMs);
@@ -0,0 +1,84 @@
+
+#include "ingest/shm_ingest.h"
+#include <fcntl.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+ShmIngest *ShmIngest_attach(char const *const name) {
+  int fd = shm_open(name, O_RDWR, 0);
+  if (fd < 0) {
+    return NULL;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(ShmRingHeader)) {
+    close(fd);
+    return NULL;
+  }
+  void *map = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (map == MAP_FAILED) {
+    return NULL;
+  }
+  ShmRingHeader *ring = (ShmRingHeader *)map;
+  bool const valid =
+      __atomic_load_n(&ring->magic, __ATOMIC_ACQUIRE) == SHM_RING_MAGIC &&
+      ring->version == SHM_RING_VERSION;
+  // Read once, the producer may rewrite the header at any time. Compared
+  // against what is left of the mapping so that it cannot overflow.
+  uint64_t const dataSize = __atomic_load_n(&ring->dataSize, __ATOMIC_RELAXED);
+  if (!valid || dataSize == 0 ||
+      dataSize > (size_t)st.st_size - sizeof(ShmRingHeader)) {
+    munmap(map, st.st_size);
+    return NULL;
+  }
+  ShmIngest *self = calloc(1, sizeof(ShmIngest));
+  if (!self) {
+    munmap(map, st.st_size);
+    return NULL;
+  }
+  self->ring = ring;
+  self->mapSize = st.st_size;
+  self->dataSize = dataSize;
+  return self;
+}
+
+void ShmIngest_detach(ShmIngest *self) {
+  if (!self) {
+    return;
+  }
+  munmap(self->ring, self->mapSize);
+  free(self);
+  return;
+}
+
+BufferError ShmIngest_drain(ShmIngest *const self, IOBuffer *const dst) {
+  BufferError res = {.result = 0, .errorCode = BUFFER_ERROR_OK};
+  // Sample eof before the spans so data written right before closing is kept.
+  bool const eof = __atomic_load_n(&self->ring->eof, __ATOMIC_ACQUIRE);
+  uint8_t const *span0, *span1;
+  size_t span0Size, span1Size;
+  // Positions live in the producer's memory, a corrupt ring is dropped like
+  // a closed one rather than read out of bounds.
+  if (!ShmRing_peek(self->ring, self->dataSize, &span0, &span0Size, &span1,
+                    &span1Size)) {
+    res.errorCode = BUFFER_ERROR_EOF;
+    return res;
+  }
+  if (span0Size + span1Size == 0) {
+    res.errorCode = (eof) ? BUFFER_ERROR_EOF : BUFFER_ERROR_EMPTY;
+    return res;
+  }
+  // Only release what dst accepted, the rest stays in the ring and the
+  // producer sees back-pressure instead of the scope silently losing data.
+  size_t const maxWrite = dst->bufferSize - 1;
+  size_t toWrite = (span0Size <= maxWrite) ? span0Size : maxWrite;
+  res.result = IOBuffer_write(dst, span0, toWrite).result;
+  if (res.result == span0Size && span1Size) {
+    toWrite = (span1Size <= maxWrite) ? span1Size : maxWrite;
+    res.result += IOBuffer_write(dst, span1, toWrite).result;
+  }
+  ShmRing_consume(self->ring, self->dataSize, res.result);
+  return res;
+}
@@ -0,0 +1,183 @@
+
+#define _GNU_SOURCE
+#include "ingest/stream_ingest.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define PIPE_SIZE (1024 * 1024)
+
+static size_t formatSampleSize(StreamFormat const format);
+static size_t formatComponents(StreamFormat const format);
+static void convertToFloat(StreamFormat const format,
+                           uint8_t const *const src, float *const dst,
+                           size_t const count);
+static void pace(StreamIngest *const self, size_t const samples);
+
+bool StreamFormat_parse(char const *const name, StreamFormat *const format) {
+  static struct {
+    char const *name;
+    StreamFormat format;
+  } const formats[] = {
+      {"f32", STREAM_FORMAT_F32}, {"cf32", STREAM_FORMAT_CF32},
+      {"s16", STREAM_FORMAT_S16}, {"cs16", STREAM_FORMAT_CS16},
+      {"u8", STREAM_FORMAT_U8},   {"cu8", STREAM_FORMAT_CU8},
+  };
+  for (size_t i = 0; i < sizeof(formats) / sizeof(formats[0]); i++) {
+    if (strcmp(name, formats[i].name) == 0) {
+      *format = formats[i].format;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool StreamFormat_isComplex(StreamFormat const format) {
+  return formatComponents(format) == 2;
+}
+
+StreamIngest *StreamIngest_create(int const fd, StreamFormat const format,
+                                  double const sampleRate) {
+  StreamIngest *self = calloc(1, sizeof(StreamIngest));
+  if (!self) {
+    return NULL;
+  }
+  self->scratch = malloc(STREAM_INGEST_SCRATCH_SIZE);
+  if (!self->scratch) {
+    free(self);
+    return NULL;
+  }
+  self->fd = fd;
+  self->format = format;
+  self->sampleRate = sampleRate;
+  clock_gettime(CLOCK_MONOTONIC, &self->start);
+  struct stat st;
+  if (fstat(fd, &st) == 0 && S_ISFIFO(st.st_mode)) {
+    // Best effort, fewer wake-ups per byte when the producer is bursty.
+    fcntl(fd, F_SETPIPE_SZ, PIPE_SIZE);
+  }
+  return self;
+}
+
+void StreamIngest_destroy(StreamIngest *self) {
+  if (!self) {
+    return;
+  }
+  free(self->scratch);
+  free(self);
+  return;
+}
+
+BufferError StreamIngest_read(StreamIngest *const self, IOBuffer *const dst) {
+  BufferError res = {.result = 0, .errorCode = BUFFER_ERROR_OK};
+  size_t const sampleSize = formatSampleSize(self->format);
+  size_t span;
+  uint8_t *spanBegin = IOBuffer_reserveWrite(dst, &span);
+  if (span < sizeof(float)) {
+    res.errorCode = BUFFER_ERROR_DATA_DROPPED;
+    return res;
+  }
+  ssize_t n;
+  if (sampleSize == sizeof(float)) {
+    // Zero-copy path: the kernel fills the ring directly. Partial samples
+    // are fine since the buffer is a byte stream.
+    do {
+      n = read(self->fd, spanBegin, span);
+    } while (n < 0 && errno == EINTR);
+    if (n <= 0) {
+      res.errorCode = BUFFER_ERROR_EOF;
+      return res;
+    }
+    IOBuffer_commitWrite(dst, n);
+    res.result = n;
+    size_t const bytes = self->carry + n;
+    self->carry = bytes % sizeof(float);
+    pace(self, bytes / sizeof(float));
+    return res;
+  }
+  size_t maxSamples = span / sizeof(float);
+  size_t maxBytes = maxSamples * sampleSize;
+  if (maxBytes > STREAM_INGEST_SCRATCH_SIZE) {
+    maxBytes = STREAM_INGEST_SCRATCH_SIZE;
+  }
+  do {
+    n = read(self->fd, self->scratch + self->carry, maxBytes - self->carry);
+  } while (n < 0 && errno == EINTR);
+  if (n <= 0) {
+    res.errorCode = BUFFER_ERROR_EOF;
+    return res;
+  }
+  size_t const bytes = self->carry + n;
+  size_t const samples = bytes / sampleSize;
+  convertToFloat(self->format, self->scratch, (float *)spanBegin, samples);
+  IOBuffer_commitWrite(dst, samples * sizeof(float));
+  self->carry = bytes - samples * sampleSize;
+  memmove(self->scratch, self->scratch + samples * sampleSize, self->carry);
+  res.result = samples * sizeof(float);
+  pace(self, samples);
+  return res;
+}
+
+static size_t formatSampleSize(StreamFormat const format) {
+  switch (format) {
+  case STREAM_FORMAT_S16:
+  case STREAM_FORMAT_CS16:
+    return sizeof(int16_t);
+  case STREAM_FORMAT_U8:
+  case STREAM_FORMAT_CU8:
+    return sizeof(uint8_t);
+  default:
+    return sizeof(float);
+  }
+}
+
+static size_t formatComponents(StreamFormat const format) {
+  switch (format) {
+  case STREAM_FORMAT_CF32:
+  case STREAM_FORMAT_CS16:
+  case STREAM_FORMAT_CU8:
+    return 2;
+  default:
+    return 1;
+  }
+}
+
+static void convertToFloat(StreamFormat const format,
+                           uint8_t const *const src, float *const dst,
+                           size_t const count) {
+  if (formatSampleSize(format) == sizeof(int16_t)) {
+    for (size_t i = 0; i < count; i++) {
+      int16_t v;
+      memcpy(&v, src + i * sizeof(v), sizeof(v));
+      dst[i] = v * (1.0f / 32768.0f);
+    }
+  } else {
+    for (size_t i = 0; i < count; i++) {
+      dst[i] = ((int)src[i] - 128) * (1.0f / 128.0f);
+    }
+  }
+  return;
+}
+
+static void pace(StreamIngest *const self, size_t const samples) {
+  self->samplesRead += samples;
+  if (self->sampleRate <= 0) {
+    return;
+  }
+  double const elapsed =
+      self->samplesRead / formatComponents(self->format) / self->sampleRate;
+  struct timespec deadline = self->start;
+  deadline.tv_sec += (time_t)elapsed;
+  deadline.tv_nsec += (long)((elapsed - (time_t)elapsed) * 1e9);
+  if (deadline.tv_nsec >= 1000000000L) {
+    deadline.tv_sec++;
+    deadline.tv_nsec -= 1000000000L;
+  }
+  while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, NULL) ==
+         EINTR) {
+  }
+  return;
+}
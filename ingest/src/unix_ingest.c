@@ -0,0 +1,194 @@
+
+#define _GNU_SOURCE
+#include "ingest/unix_ingest.h"
+#include <errno.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#define EVENTS_PER_POLL (UNIX_INGEST_MAX_CLIENTS + 1)
+
+static void acceptClient(UnixIngest *const self);
+static void dropClient(UnixIngest *const self, int const fd);
+static bool drainClient(UnixIngest *const self, int const fd,
+                        IOBuffer *const dst, BufferError *const res);
+
+UnixIngest *UnixIngest_create(char const *const path) {
+  struct sockaddr_un addr = {.sun_family = AF_UNIX};
+  if (strlen(path) >= sizeof(addr.sun_path)) {
+    errno = ENAMETOOLONG;
+    return NULL;
+  }
+  strcpy(addr.sun_path, path);
+  UnixIngest *self = calloc(1, sizeof(UnixIngest));
+  if (!self) {
+    return NULL;
+  }
+  self->batchStorage = malloc(UNIX_INGEST_BATCH * UNIX_INGEST_MSG_SIZE);
+  self->iovs = calloc(UNIX_INGEST_BATCH, sizeof(struct iovec));
+  self->msgs = calloc(UNIX_INGEST_BATCH, sizeof(struct mmsghdr));
+  self->listenFd = -1;
+  self->epollFd = -1;
+  if (!self->batchStorage || !self->iovs || !self->msgs) {
+    goto error;
+  }
+  for (size_t i = 0; i < UNIX_INGEST_BATCH; i++) {
+    self->iovs[i].iov_base = self->batchStorage + i * UNIX_INGEST_MSG_SIZE;
+    self->iovs[i].iov_len = UNIX_INGEST_MSG_SIZE;
+    self->msgs[i].msg_hdr.msg_iov = &self->iovs[i];
+    self->msgs[i].msg_hdr.msg_iovlen = 1;
+  }
+  strcpy(self->path, path);
+  self->allowedUid = geteuid();
+  self->listenFd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+  self->epollFd = epoll_create1(EPOLL_CLOEXEC);
+  if (self->listenFd < 0 || self->epollFd < 0) {
+    goto error;
+  }
+  unlink(path);
+  if (bind(self->listenFd, (struct sockaddr *)&addr, sizeof(addr)) != 0 ||
+      listen(self->listenFd, UNIX_INGEST_MAX_CLIENTS) != 0) {
+    goto error;
+  }
+  struct epoll_event ev = {.events = EPOLLIN, .data.fd = self->listenFd};
+  if (epoll_ctl(self->epollFd, EPOLL_CTL_ADD, self->listenFd, &ev) != 0) {
+    goto error;
+  }
+  return self;
+error:
+  if (self->listenFd >= 0) {
+    close(self->listenFd);
+  }
+  if (self->epollFd >= 0) {
+    close(self->epollFd);
+  }
+  free(self->batchStorage);
+  free(self->iovs);
+  free(self->msgs);
+  free(self);
+  return NULL;
+}
+
+void UnixIngest_destroy(UnixIngest *self) {
+  if (!self) {
+    return;
+  }
+  for (size_t i = 0; i < self->numberClients; i++) {
+    close(self->clients[i]);
+  }
+  close(self->listenFd);
+  close(self->epollFd);
+  unlink(self->path);
+  free(self->batchStorage);
+  free(self->iovs);
+  free(self->msgs);
+  free(self);
+  return;
+}
+
+BufferError UnixIngest_poll(UnixIngest *const self, IOBuffer *const dst,
+                            int const timeoutMs) {
+  BufferError res = {.result = 0, .errorCode = BUFFER_ERROR_OK};
+  struct epoll_event events[EVENTS_PER_POLL];
+  int n = epoll_wait(self->epollFd, events, EVENTS_PER_POLL, timeoutMs);
+  for (int i = 0; i < n; i++) {
+    int const fd = events[i].data.fd;
+    if (fd == self->listenFd) {
+      acceptClient(self);
+      continue;
+    }
+    bool alive = drainClient(self, fd, dst, &res);
+    if (!alive || (events[i].events & (EPOLLHUP | EPOLLRDHUP | EPOLLERR))) {
+      dropClient(self, fd);
+    }
+  }
+  return res;
+}
+
+static void acceptClient(UnixIngest *const self) {
+  int fd = accept4(self->listenFd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+  if (fd < 0) {
+    return;
+  }
+  struct ucred cred;
+  socklen_t credLen = sizeof(cred);
+  if (getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &cred, &credLen) != 0 ||
+      (cred.uid != self->allowedUid && cred.uid != 0)) {
+    printf("[UNIX] - rejected producer (uid %d)\n", (int)cred.uid);
+    close(fd);
+    return;
+  }
+  if (self->numberClients == UNIX_INGEST_MAX_CLIENTS) {
+    printf("[UNIX] - too many producers, rejected pid %d\n", (int)cred.pid);
+    close(fd);
+    return;
+  }
+  struct epoll_event ev = {.events = EPOLLIN | EPOLLRDHUP, .data.fd = fd};
+  if (epoll_ctl(self->epollFd, EPOLL_CTL_ADD, fd, &ev) != 0) {
+    close(fd);
+    return;
+  }
+  self->clients[self->numberClients++] = fd;
+  printf("[UNIX] - producer connected (pid %d)\n", (int)cred.pid);
+  return;
+}
+
+static void dropClient(UnixIngest *const self, int const fd) {
+  epoll_ctl(self->epollFd, EPOLL_CTL_DEL, fd, NULL);
+  close(fd);
+  for (size_t i = 0; i < self->numberClients; i++) {
+    if (self->clients[i] == fd) {
+      self->clients[i] = self->clients[--self->numberClients];
+      break;
+    }
+  }
+  printf("[UNIX] - producer disconnected\n");
+  return;
+}
+
+static bool drainClient(UnixIngest *const self, int const fd,
+                        IOBuffer *const dst, BufferError *const res) {
+  while (true) {
+    int n = recvmmsg(fd, self->msgs, UNIX_INGEST_BATCH, MSG_DONTWAIT, NULL);
+    if (n < 0) {
+      return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+    }
+    if (n == 0) {
+      return false;
+    }
+    for (int i = 0; i < n; i++) {
+      // A zero-length read is how the kernel reports an orderly shutdown,
+      // producers must not send empty messages.
+      if (self->msgs[i].msg_len == 0) {
+        return false;
+      }
+      // The rest of an oversized message is lost, which would tear the
+      // stream: the producer is disconnected instead.
+      if (self->msgs[i].msg_hdr.msg_flags & MSG_TRUNC) {
+        printf("[UNIX] - message over %d bytes, disconnecting producer\n",
+               UNIX_INGEST_MSG_SIZE);
+        return false;
+      }
+      // Drop the tail of partial samples.
+      size_t len = self->msgs[i].msg_len;
+      len -= len % sizeof(float);
+      if (len == 0) {
+        continue;
+      }
+      BufferError err = IOBuffer_write(dst, self->iovs[i].iov_base, len);
+      res->result += err.result;
+      if (err.errorCode != BUFFER_ERROR_OK) {
+        res->errorCode = err.errorCode;
+      }
+    }
+    if (n < UNIX_INGEST_BATCH) {
+      return true;
+    }
+  }
+}
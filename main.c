@@ -1,29 +1,113 @@
 
 #include "buffer/include/buffer/io_buffer.h"
+#include "dsp/include/dsp/autoset.h"
+#include "dsp/include/dsp/constellation.h"
+#include "dsp/include/dsp/decimate.h"
+#include "dsp/include/dsp/deep_memory.h"
+#include "dsp/include/dsp/envelope.h"
+#include "dsp/include/dsp/eye.h"
+#include "dsp/include/dsp/interpolate.h"
+#include "dsp/include/dsp/persistence.h"
+#include "dsp/include/dsp/roll.h"
+#include "dsp/include/dsp/segments.h"
+#include "dsp/include/dsp/spectrum.h"
+#include "dsp/include/dsp/waterfall.h"
+#include "dsp/include/dsp/trigger.h"
+#include "dsp/include/dsp/waveform_average.h"
+#include "ingest/include/ingest/shm_ingest.h"
+#include "ingest/include/ingest/stream_ingest.h"
+#include "ingest/include/ingest/unix_ingest.h"
+#include "render/include/render/framebuffer.h"
 #include <assert.h>
 #include <errno.h>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <math.h>
+#include <net/if.h>
 #include <netdb.h>
 #include <netinet/in.h>
+#include <netinet/udp.h>
 #include <pthread.h>
 #include <raylib.h>
+#include <rlgl.h>
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <sys/socket.h>
+#include <time.h>
 #include <unistd.h>
 
 #define RAYGUI_IMPLEMENTATION
 #include "raygui.h"
 
-#define DATA_SIZE (4096 * sizeof(float))
+#define MAX_WINDOW_SAMPLES (10 * 1000 * 1000)
+// LTTB and RMS reduce raw samples up to this, wider views use the pyramid.
+#define RAW_REDUCE_MAX_SAMPLES (1000 * 1000)
+#define DEFAULT_WINDOW_SAMPLES 64
+#define DATA_SIZE (1024 * 1024 * sizeof(float))
 IOBuffer *data;
 
-#define MAX_SCREEN_DATA_SIZE (128 * sizeof(float))
+#define DEFAULT_DEPTH_MB 64
+#define ACQUISITION_CHUNK_SIZE (64 * 1024)
+#define ZOOM_STEP 0.1f
+#define PAN_STEP_DIVIDER 10
+#define AUTO_TRIGGER_TIMEOUT_S 0.1
+#define DEFAULT_TRIGGER_POSITION 0.5f
+#define DEFAULT_PERSIST_DECAY_S "0.5"
+#define DEFAULT_FFT_ORDER 12
+#define SPECTRUM_DB_MIN -120.0f
+#define SPECTRUM_DB_MAX 10.0f
+#define SPECTRUM_CHUNK_SIZE (64 * 1024)
+#define POINT_BATCH 1024
+#define POINT_SIZE 4.0f
+#define DEFAULT_SINC_POINTS "8"
+#define Y_LIMIT 50
+#define AUTOSET_MARGIN 0.1f      // Of the peak to peak amplitude.
+#define AUTOSET_PERIODS 3        // Periods shown by the timebase.
+#define AUTORANGE_MIN_FILL 0.3f  // Rescale when the signal spans less.
+#define AUTORANGE_MAX_RATIO 2.0f // Retime when off by more than that.
+#define DEFAULT_AVERAGE_COUNT "16"
+#define ENVELOPE_ALPHA 0.25f
+#define TRIGGER_QUEUE 1024 // Triggers waiting for the end of their window.
+#define DEFAULT_SEGMENTS "100"
+#define SEGMENT_PLAY_PERIOD_S 0.1
+#define HEADLESS_WAIT_NS 1000000000L
+#define HEADLESS_IDLE_S 10.0 // Give up when no window completes for that long.
+#define GRATICULE_DIVISIONS_X 10
+#define GRATICULE_DIVISIONS_Y 8
 
 #define DEFAULT_FPS 1000L
+#define FALLBACK_REFRESH_RATE 60
+#define PACING_POLL_NS 10000000L
 #define DEFAULT_PORT "6969"
+#define DEFAULT_MAX_DATAGRAM_SIZE "65536"
+#define MAX_DATAGRAM_SIZE (64 * 1024)
+#define UDP_RCVBUF_SIZE (4 * 1024 * 1024)
+#define INGEST_POLL_PERIOD_NS 50000L
+#define SHM_ATTACH_PERIOD_NS 100000000L
+
+typedef enum {
+  DISPLAY_YT,        // Amplitude against time.
+  DISPLAY_EYE,       // Stream folded on the recovered symbol clock.
+  DISPLAY_XY,        // Density of the first channel against the second one.
+  DISPLAY_FFT,       // Averaged spectrum, computed by spectrumTask.
+  DISPLAY_WATERFALL, // Spectrum history, one row per FFT.
+  DISPLAY_SEGMENTS   // Segmented acquisition and its browser.
+} DisplayMode;
+
+typedef enum {
+  PACING_EVENTS, // Redraw on new data, triggers or input, at most per vsync.
+  PACING_FIXED   // Redraw continuously at --fps.
+} Pacing;
+
+typedef enum {
+  SEGMENT_VIEW_STEP,     // One segment, chosen by its number.
+  SEGMENT_VIEW_PLAY,     // One segment after the other.
+  SEGMENT_VIEW_ALL,      // Every stored segment as a density map.
+  SEGMENT_VIEW_REFERENCE // One segment against the first one.
+} SegmentView;
 
 typedef void (*renderDataFunc_t)(void const *const data,
                                  size_t const dataLenght, float const deltaX,
@@ -31,17 +115,119 @@ typedef void (*renderDataFunc_t)(void const *const data,
                                  int const yMin, int const yMax);
 
 void *recvTask(void *);
+void *shmTask(void *);
+void *unixTask(void *);
+void *streamTask(void *);
+void *acquisitionTask(void *);
+void *spectrumTask(void *);
+
+typedef struct {
+  DeepMemory *memory;
+  volatile bool running; // Cleared by STOP, incoming data is then discarded.
+  Trigger trigger;
+  volatile int triggerMode;
+  volatile uint64_t holdoff;
+  volatile size_t windowFrames;
+  volatile float triggerPosition; // Fraction of the window before trigger.
+  volatile uint64_t lastTrigger;  // Last trigger whose window is complete.
+  volatile uint64_t triggerCount;
+  volatile uint64_t droppedTriggers; // Lost to a full trigger queue.
+  volatile bool ended;               // Input ended, nothing more is stored.
+  Persistence *persistence;
+  volatile bool persist;    // Draw every acquired window into persistence.
+  volatile bool freeRun;    // No trigger: consecutive windows are waveforms.
+  volatile bool averaging;  // Add every triggered window to average.
+  volatile bool enveloping; // Add every triggered window to envelope.
+  volatile bool segmenting; // Store triggered windows into segments.
+  volatile float yMin;
+  volatile float yMax;
+  EyeDiagram *eye;
+  Constellation *constellation;
+  IOBuffer *spectrumFeed; // Full stream copy for spectrumTask.
+  volatile int display;
+  Autoset *autoset;
+  WaveformAverage *average;
+  Envelope *envelope;
+  Segments *segments;
+} AcquisitionTaskArgs;
+
+typedef struct {
+  IOBuffer *feed;
+  Spectrum *spectrum;
+  size_t channels;
+  Waterfall *waterfall;
+  volatile bool history;      // Push every spectrum into waterfall.
+  volatile uint64_t spectra; // Blocks transformed so far.
+} SpectrumTaskArgs;
+
+typedef struct {
+  char const *port;
+  char const *group; // Multicast group to join, NULL for unicast.
+  char const *iface; // Interface name or address for the group, NULL for any.
+  size_t maxDatagramSize;
+  bool gro;
+} UdpTaskArgs;
+
+typedef struct {
+  char const *fifoPath; // NULL reads from stdin.
+  StreamFormat format;
+  double sampleRate;
+} StreamTaskArgs;
+
+typedef struct {
+  AcquisitionTaskArgs *acquisition;
+  int width;
+  int height;
+  size_t windowSamples;
+  size_t renders;      // Number of frames rendered before exiting.
+  char const *pngPath; // Last frame is written there, NULL for none.
+  float persistDecay;  // Persistence time constant in s, 0 never fades.
+} HeadlessArgs;
+
+typedef struct {
+  uint64_t shownTriggerCount; // Triggers the view has followed.
+  double lastTriggerTime;     // When the last of them was seen.
+  uint64_t liveEnd;           // End of the live window, 0 before any.
+} LiveView;
 
 size_t decode_screen_data_size(float screen_data_size);
 
 int get_fps_from_argv(int argc, char *argv[], int const defaultVal);
 char const *get_port_from_argv(int argc, char *argv[],
                                char const *const defaultVal);
+char const *get_option_from_argv(int argc, char *argv[],
+                                 char const *const option,
+                                 char const *const defaultVal);
+bool get_flag_from_argv(int argc, char *argv[], char const *const flag);
+bool get_trigger_from_argv(int argc, char *argv[], Trigger *const trigger);
+int get_choice_from_argv(int argc, char *argv[], char const *const option,
+                         char const *const *const choices, size_t const count,
+                         int const defaultVal);
+
+void writeSamples(uint8_t const *const samples, size_t const size);
+float *copyWindow(DeepMemory *const memory, uint64_t const first,
+                  size_t const frames, float **const scratch,
+                  size_t *const scratchFrames);
+void persistWindow(AcquisitionTaskArgs *const acquisition, uint64_t const first,
+                   size_t const frames, float **const scratch,
+                   size_t *const scratchFrames);
+void collectWindow(AcquisitionTaskArgs *const acquisition,
+                   uint64_t const trigger, uint64_t const first,
+                   size_t const frames, float **const scratch,
+                   size_t *const scratchFrames);
 
 void renderByPoints(float const *const data, size_t const dataLenght,
                     float const deltaX, int const screenWidth,
                     int const screenHeight, int const yMin, int const yMax);
 
+void renderByPointsComplex(float const *const data, size_t const dataLenght,
+                           float const deltaX, int const screenWidth,
+                           int const screenHeight, int const yMin,
+                           int const yMax);
+
+void drawPointQuads(Vector2 const *const points, size_t const count,
+                    float const size, Color const color);
+
 void renderByLines(float const *const data, size_t const dataLenght,
                    float const deltaX, int const screenWidth,
                    int const screenHeight, int const yMin, int const yMax);
@@ -51,57 +237,978 @@ void renderByLinesComplex(float const *const data, size_t const dataLenght,
                           int const screenHeight, int const yMin,
                           int const yMax);
 
+void renderInterpolated(float const *const data, size_t const points,
+                        size_t const channels, float const deltaX,
+                        float const channelShift, int const screenHeight,
+                        int const yMin, int const yMax);
+
+void renderPeakDetect(float const *const columnMin,
+                      float const *const columnMax, size_t const columns,
+                      size_t const channels, int const screenWidth,
+                      int const screenHeight, int const yMin, int const yMax);
+
+void renderEnvelope(float const *const lower, float const *const upper,
+                    size_t const points, size_t const channels,
+                    float const deltaX, float const channelShift,
+                    int const screenHeight, int const yMin, int const yMax);
+
+void renderDecimated(float const *const pointsX, float const *const pointsY,
+                     size_t const points, size_t const channels,
+                     size_t const frames, int const screenWidth,
+                     int const screenHeight, int const yMin, int const yMax);
+
+void renderSpectrum(float const *const columnDb, size_t const columns,
+                    int const screenWidth, int const screenHeight,
+                    float const dbMin, float const dbMax);
+
+bool inputPending(void);
+
+void applyAutoset(AutosetEstimate const *const estimate, bool const gentle,
+                  size_t const channels, float const maxWindowExponent,
+                  int *const yMin, int *const yMax,
+                  float *const windowExponent, float *const triggerLevel);
+
+bool followLiveView(LiveView *const view,
+                    AcquisitionTaskArgs *const acquisition,
+                    uint64_t const newest, size_t const frames,
+                    double const now);
+
+int runHeadless(HeadlessArgs const *const args);
+bool rasterizeWindow(Framebuffer *const framebuffer, DeepMemory *const memory,
+                     uint64_t const first, size_t const frames,
+                     float const yMin, float const yMax, float *const scratch,
+                     float *const pointsX, float *const pointsY);
+double monotonicSeconds(void);
+
 int main(int argc, char *argv[]) {
   int const fps = get_fps_from_argv(argc, argv, DEFAULT_FPS);
-  char const *port = get_port_from_argv(argc, argv, DEFAULT_PORT);
+  UdpTaskArgs udpArgs = {
+      .port = get_port_from_argv(argc, argv, DEFAULT_PORT),
+      .group = get_option_from_argv(argc, argv, "--mcast", NULL),
+      .iface = get_option_from_argv(argc, argv, "--iface", NULL),
+      .maxDatagramSize =
+          strtoul(get_option_from_argv(argc, argv, "--max-dgram",
+                                       DEFAULT_MAX_DATAGRAM_SIZE),
+                  NULL, 10),
+      .gro = !get_flag_from_argv(argc, argv, "--no-gro"),
+  };
+  char const *shmName = get_option_from_argv(argc, argv, "--shm", NULL);
+  char const *unixPath = get_option_from_argv(argc, argv, "--unix", NULL);
+  StreamTaskArgs streamArgs = {
+      .fifoPath = get_option_from_argv(argc, argv, "--fifo", NULL),
+      .format = STREAM_FORMAT_F32,
+      .sampleRate = strtod(get_option_from_argv(argc, argv, "--rate", "0"),
+                           NULL),
+  };
+  bool const useStream =
+      get_flag_from_argv(argc, argv, "--stdin") || streamArgs.fifoPath;
+  char const *formatName = get_option_from_argv(argc, argv, "--format", "f32");
+  if (!StreamFormat_parse(formatName, &streamArgs.format)) {
+    fprintf(stderr, "unknown format %s\n", formatName);
+    return 1;
+  }
+  // Datagram, Unix socket and shared memory producers write float32
+  // samples, cf32 reads them as I/Q pairs.
+  if (!useStream && streamArgs.format != STREAM_FORMAT_F32 &&
+      streamArgs.format != STREAM_FORMAT_CF32) {
+    fprintf(stderr, "format %s needs --stdin or --fifo\n", formatName);
+    return 1;
+  }
+  // A datagram carries at least one whole frame.
+  size_t const frameBytes =
+      sizeof(float) * ((StreamFormat_isComplex(streamArgs.format)) ? 2 : 1);
+  if (udpArgs.maxDatagramSize < frameBytes ||
+      udpArgs.maxDatagramSize > MAX_DATAGRAM_SIZE) {
+    fprintf(stderr, "invalid max datagram size\n");
+    return 1;
+  }
   data = IOBuffer_create(DATA_SIZE);
   assert(data);
 
   pthread_t recvThread;
-  pthread_create(&recvThread, NULL, recvTask, (void *)port);
+  if (shmName) {
+    pthread_create(&recvThread, NULL, shmTask, (void *)shmName);
+  } else if (unixPath) {
+    pthread_create(&recvThread, NULL, unixTask, (void *)unixPath);
+  } else if (useStream) {
+    pthread_create(&recvThread, NULL, streamTask, (void *)&streamArgs);
+  } else {
+    pthread_create(&recvThread, NULL, recvTask, (void *)&udpArgs);
+  }
 
   SetTraceLogLevel(LOG_WARNING);
   const int screenWidth = 800;
   const int screenHeight = 450;
-  InitWindow(screenWidth, screenHeight, "Data Visualizer");
+  float const persistDecay = strtof(
+      get_option_from_argv(argc, argv, "--persist-decay",
+                           DEFAULT_PERSIST_DECAY_S),
+      NULL);
+  uint8_t *persistPixels = calloc(screenWidth * screenHeight, 4);
+  assert(persistPixels);
 
   int yMax = 1;
   int yMin = -1;
-  // renderDataFunc_t renderFunc = (renderDataFunc_t)renderByPoints;
-  renderDataFunc_t renderFunc = (renderDataFunc_t)renderByLines;
-  // renderDataFunc_t renderFunc = (renderDataFunc_t)renderByLinesComplex;
+  bool const dots = get_flag_from_argv(argc, argv, "--dots");
+  renderDataFunc_t renderFunc = (dots) ? (renderDataFunc_t)renderByPoints
+                                       : (renderDataFunc_t)renderByLines;
+  bool const complexData = StreamFormat_isComplex(streamArgs.format);
+  if (complexData) {
+    renderFunc = (dots) ? (renderDataFunc_t)renderByPointsComplex
+                        : (renderDataFunc_t)renderByLinesComplex;
+  }
+  size_t const channels = (complexData) ? 2 : 1;
+  size_t const depthMB = strtoul(
+      get_option_from_argv(argc, argv, "--depth", "0"), NULL, 10);
+  double const samplesPerSymbol =
+      strtod(get_option_from_argv(argc, argv, "--iq-sps", "0"), NULL);
+  if (samplesPerSymbol != 0 && !(samplesPerSymbol >= 2)) {
+    fprintf(stderr, "invalid iq samples per symbol\n");
+    return 1;
+  }
+  AcquisitionTaskArgs acquisitionArgs = {
+      .memory = DeepMemory_create(
+          ((depthMB) ? depthMB : DEFAULT_DEPTH_MB) * 1024 * 1024, channels),
+      .running = true,
+      .triggerMode = TRIGGER_MODE_AUTO,
+      .holdoff = strtoull(
+          get_option_from_argv(argc, argv, "--trig-holdoff", "0"), NULL, 10),
+      .windowFrames = DEFAULT_WINDOW_SAMPLES / channels,
+      .triggerPosition = DEFAULT_TRIGGER_POSITION,
+      .persistence = Persistence_create(screenWidth, screenHeight),
+      .persist = get_flag_from_argv(argc, argv, "--persist"),
+      .yMin = yMin,
+      .yMax = yMax,
+      .eye = EyeDiagram_create(
+          screenWidth, screenHeight,
+          strtod(get_option_from_argv(argc, argv, "--eye-ui", "0"), NULL)),
+      .constellation =
+          Constellation_create(screenHeight, screenHeight, samplesPerSymbol),
+      .spectrumFeed = IOBuffer_create(DATA_SIZE),
+      .display = DISPLAY_YT,
+      .autoset = Autoset_create(),
+      .average = WaveformAverage_create(),
+      .envelope = Envelope_create(screenWidth, channels),
+      .segments = Segments_create(channels),
+  };
+  assert(acquisitionArgs.memory && "deep memory allocation failed");
+  assert(acquisitionArgs.persistence && "persistence allocation failed");
+  assert(acquisitionArgs.eye && "eye diagram allocation failed");
+  assert(acquisitionArgs.constellation && "constellation allocation failed");
+  assert(acquisitionArgs.spectrumFeed);
+  assert(acquisitionArgs.autoset);
+  assert(acquisitionArgs.average);
+  assert(acquisitionArgs.envelope);
+  assert(acquisitionArgs.segments);
+  char const *const windowNames[] = {"hann", "bh", "flattop"};
+  char const *const averageNames[] = {"none", "linear", "peak", "max"};
+  int fftWindow = get_choice_from_argv(argc, argv, "--fft-window", windowNames,
+                                       3, SPECTRUM_WINDOW_HANN);
+  int fftAverage = get_choice_from_argv(argc, argv, "--fft-avg", averageNames,
+                                        4, SPECTRUM_AVERAGE_NONE);
+  size_t const fftAverages = strtoul(
+      get_option_from_argv(argc, argv, "--fft-averages", "8"), NULL, 10);
+  size_t const fftSize = strtoul(
+      get_option_from_argv(argc, argv, "--fft-size", "0"), NULL, 10);
+  int fftOrder = (fftSize) ? (int)log2((double)fftSize) : DEFAULT_FFT_ORDER;
+  // The waterfall fills the screen below the controls.
+  int const waterfallTop = 160;
+  int const waterfallRows = screenHeight - waterfallTop;
+  SpectrumTaskArgs spectrumArgs = {
+      .feed = acquisitionArgs.spectrumFeed,
+      .spectrum = Spectrum_create(complexData),
+      .channels = channels,
+      .waterfall = Waterfall_create(screenWidth, waterfallRows),
+  };
+  assert(spectrumArgs.spectrum && spectrumArgs.waterfall);
+  // Sizes that are not a power of two are rejected, not rounded down.
+  if (fftWindow < 0 || fftAverage < 0 ||
+      (fftSize && ((size_t)1 << fftOrder) != fftSize) ||
+      !Spectrum_configure(spectrumArgs.spectrum, (size_t)1 << fftOrder,
+                          fftWindow, fftAverage, fftAverages)) {
+    fprintf(stderr, "invalid spectrum options\n");
+    return 1;
+  }
+  pthread_t spectrumThread;
+  pthread_create(&spectrumThread, NULL, spectrumTask, (void *)&spectrumArgs);
+  if (!get_trigger_from_argv(argc, argv, &acquisitionArgs.trigger)) {
+    fprintf(stderr, "invalid trigger options\n");
+    return 1;
+  }
+  DeepMemory *const memory = acquisitionArgs.memory;
+  pthread_t acquisitionThread;
+  pthread_create(&acquisitionThread, NULL, acquisitionTask,
+                 (void *)&acquisitionArgs);
+  float const maxWindowExponent = log10f(memory->capacity * channels);
+  if (get_flag_from_argv(argc, argv, "--headless")) {
+    char const *const window =
+        get_option_from_argv(argc, argv, "--window", NULL);
+    HeadlessArgs const headlessArgs = {
+        .acquisition = &acquisitionArgs,
+        .width = screenWidth,
+        .height = screenHeight,
+        .windowSamples =
+            (window) ? strtoul(window, NULL, 10) : DEFAULT_WINDOW_SAMPLES,
+        .renders = strtoul(get_option_from_argv(argc, argv, "--frames", "1"),
+                           NULL, 10),
+        .pngPath = get_option_from_argv(argc, argv, "--png", NULL),
+        .persistDecay = persistDecay,
+    };
+    if (headlessArgs.windowSamples < channels ||
+        headlessArgs.windowSamples > MAX_WINDOW_SAMPLES) {
+      fprintf(stderr, "invalid headless window\n");
+      return 1;
+    }
+    if (headlessArgs.renders < 1) {
+      fprintf(stderr, "invalid headless frames\n");
+      return 1;
+    }
+    return runHeadless(&headlessArgs);
+  }
 
-  SetTargetFPS(fps);
+  InitWindow(screenWidth, screenHeight, "Data Visualizer");
+  Image persistImage = {
+      .data = persistPixels,
+      .width = screenWidth,
+      .height = screenHeight,
+      .mipmaps = 1,
+      .format = PIXELFORMAT_UNCOMPRESSED_R8G8B8A8,
+  };
+  Texture2D const persistTexture = LoadTextureFromImage(persistImage);
+  // Rows are uploaded one at a time as they arrive, the texture is never
+  // rewritten as a whole.
+  Image waterfallImage = GenImageColor(screenWidth, waterfallRows, BLACK);
+  Texture2D const waterfallTexture = LoadTextureFromImage(waterfallImage);
+  UnloadImage(waterfallImage);
+  uint8_t *waterfallLine = calloc(screenWidth, 4);
+  assert(waterfallLine);
+  uint64_t waterfallSeen = 0;
+  size_t waterfallNewest = 0;
+  // Roll mode keeps the trace in a ring texture, one column per pixel.
+  bool roll = get_flag_from_argv(argc, argv, "--roll");
+  uint8_t const rollColors[][4] = {{0, 0, 0, 255}, {0, 121, 241, 255}};
+  uint8_t const rollComplexColors[][4] = {{230, 41, 55, 255},
+                                          {0, 121, 241, 255}};
+  RollChart *rollChart =
+      RollChart_create(screenWidth, screenHeight, channels,
+                       (complexData) ? rollComplexColors : rollColors);
+  assert(rollChart);
+  Image rollImage = {
+      .data = rollChart->pixels, // All zero, the layout does not matter.
+      .width = screenWidth,
+      .height = screenHeight,
+      .mipmaps = 1,
+      .format = PIXELFORMAT_UNCOMPRESSED_R8G8B8A8,
+  };
+  Texture2D const rollTexture = LoadTextureFromImage(rollImage);
+  uint64_t rollEnd = 0; // Absolute index of the next column to draw.
+  size_t rollFrames = 0;
+  int rollYMin = yMin;
+  int rollYMax = yMax;
+  // Sparse windows can be drawn sin(x)/x interpolated, sincPoints points per
+  // sample, from the visible frames and a few neighbours as filter context.
+  bool sinc = get_flag_from_argv(argc, argv, "--sinc");
+  size_t const sincPoints = strtoul(
+      get_option_from_argv(argc, argv, "--sinc-points", DEFAULT_SINC_POINTS),
+      NULL, 10);
+  if (sincPoints < 1 || sincPoints > INTERPOLATE_MAX_POINTS) {
+    fprintf(stderr, "invalid sinc points\n");
+    return 1;
+  }
+  size_t const sincFrames = screenWidth + INTERPOLATE_TAPS;
+  Interpolator *interpolator = Interpolator_create(sincPoints, sincFrames);
+  float *sincBuffer =
+      calloc((sincFrames * sincPoints + 1) * channels, sizeof(float));
+  assert(interpolator && sincBuffer);
+  size_t sincCount = 0; // Interpolated values per channel.
 
-  float samplesPerWindow = MAX_SCREEN_DATA_SIZE / (2 * (float)sizeof(float));
-  uint8_t internalBuffer[MAX_SCREEN_DATA_SIZE];
-  memset(internalBuffer, 0, sizeof(internalBuffer));
+  char const *const pacingNames[] = {"events", "fixed"};
+  int const pacing = get_choice_from_argv(argc, argv, "--pacing", pacingNames,
+                                          2, PACING_EVENTS);
+  if (pacing < 0) {
+    fprintf(stderr, "invalid pacing\n");
+    return 1;
+  }
+  if (pacing == PACING_EVENTS) {
+    int const refreshRate = GetMonitorRefreshRate(GetCurrentMonitor());
+    SetTargetFPS((refreshRate > 0) ? refreshRate : FALLBACK_REFRESH_RATE);
+  } else {
+    SetTargetFPS(fps);
+  }
+
+  // The window slider is logarithmic so that 1 to 10^9 samples stay usable.
+  float windowExponent = log10f(DEFAULT_WINDOW_SAMPLES);
+  float *internalBuffer = calloc(MAX_WINDOW_SAMPLES, sizeof(float));
+  float *columnMin = calloc(screenWidth * channels, sizeof(float));
+  float *columnMax = calloc(screenWidth * channels, sizeof(float));
+  float *lttbX = calloc(screenWidth * channels, sizeof(float));
+  float *lttbY = calloc(screenWidth * channels, sizeof(float));
+  float *spectrumDb = calloc(screenWidth, sizeof(float));
+  assert(internalBuffer && columnMin && columnMax && lttbX && lttbY &&
+         spectrumDb);
+  int decimateMode = DECIMATE_PEAK;
+  int reducedMode = decimateMode;
+  bool reducedSinc = sinc;
+  size_t reducedSamples = 0;
+  uint64_t reducedEnd = 0;
+  LiveView live = {0};
+  int64_t panFrames = 0; // How far back from the live window the view ends.
+  int triggerMode = acquisitionArgs.triggerMode;
+  int triggerType = acquisitionArgs.trigger.type;
+  int triggerSlope = acquisitionArgs.trigger.slope;
+  float triggerLevel = acquisitionArgs.trigger.level;
+  float triggerPosition = acquisitionArgs.triggerPosition;
+  bool persist = acquisitionArgs.persist;
+  // The histogram is only meaningful for one scale, restart it on changes.
+  int persistYMin = yMin;
+  int persistYMax = yMax;
+  size_t persistSamples = 0;
+  int display = acquisitionArgs.display;
+  int mapYMin = yMin;
+  int mapYMax = yMax;
+  bool autoRange = get_flag_from_argv(argc, argv, "--auto-range");
+  bool autosetPressed = false;
+  // Averaging and envelope restart when the trigger alignment changes.
+  char const *const waveformAverageNames[] = {"off", "exp", "box"};
+  int averageMode = get_choice_from_argv(argc, argv, "--avg",
+                                         waveformAverageNames, 3,
+                                         WAVEFORM_AVERAGE_OFF);
+  int averageCount = strtol(
+      get_option_from_argv(argc, argv, "--avg-count", DEFAULT_AVERAGE_COUNT),
+      NULL, 10);
+  if (averageMode < 0 || averageCount < 2 ||
+      averageCount > WAVEFORM_AVERAGE_MAX_COUNT) {
+    fprintf(stderr, "invalid averaging options\n");
+    return 1;
+  }
+  float alignPosition = triggerPosition;
+  float alignLevel = triggerLevel;
+  size_t alignSamples = 0;
+  size_t averagedCount = 0;
+  bool averageValid = false;
+  bool envelope = get_flag_from_argv(argc, argv, "--envelope");
+  bool envelopeCleared = false;
+  float *envelopeMin = calloc(screenWidth * channels, sizeof(float));
+  float *envelopeMax = calloc(screenWidth * channels, sizeof(float));
+  assert(envelopeMin && envelopeMax);
+  size_t envelopePoints = 0;
+  size_t envelopeCount = 0;
+  // Segments are armed on entering their display, on RUN and when their
+  // geometry changes, the browser reads them once acquisition stopped.
+  int segmentCount = strtol(
+      get_option_from_argv(argc, argv, "--segments", DEFAULT_SEGMENTS), NULL,
+      10);
+  if (segmentCount < 1 || segmentCount > SEGMENTS_MAX_COUNT) {
+    fprintf(stderr, "invalid segments\n");
+    return 1;
+  }
+  Segments *const segments = acquisitionArgs.segments;
+  int segmentView = SEGMENT_VIEW_STEP;
+  int segmentNumber = 1; // Shown segment, from 1.
+  bool segmentsShown = false;
+  bool segmentsArmed = false;
+  int armedCount = 0;
+  size_t armedFrames = 0;
+  size_t segmentsFilled = 0;
+  bool segmentValid = false;
+  SegmentStamp segmentStamp;
+  SegmentStamp previousStamp;
+  size_t comparePoints = 0;
+  double segmentPlayTime = 0;
+  Persistence *segmentMap = Persistence_create(screenWidth, screenHeight);
+  assert(segmentMap);
+  size_t overlaidCount = 0;
+  int overlayYMin = yMin;
+  int overlayYMax = yMax;
   while (!WindowShouldClose()) // Detect window close button or ESC key
   {
-    size_t screen_data_size = (size_t)samplesPerWindow * sizeof(float);
-    float delta = screenWidth / ((float)screen_data_size / sizeof(float));
-    BufferError err =
-        IOBuffer_nextAsync(data, internalBuffer, screen_data_size);
+    bool const runPressed = IsKeyPressed(KEY_SPACE);
+    // AUTOSET fits scale, timebase and trigger level to the signal once,
+    // auto-range keeps them fitted and only moves them when they are off.
+    AutosetEstimate estimate;
+    if ((autosetPressed || autoRange) &&
+        Autoset_estimate(acquisitionArgs.autoset, &estimate)) {
+      applyAutoset(&estimate, !autosetPressed, channels, maxWindowExponent,
+                   &yMin, &yMax, &windowExponent, &triggerLevel);
+    }
+    autosetPressed = false;
+    windowExponent -= GetMouseWheelMove() * ZOOM_STEP;
+    windowExponent = (windowExponent < 0) ? 0 : windowExponent;
+    windowExponent = (windowExponent > maxWindowExponent) ? maxWindowExponent
+                                                          : windowExponent;
+    size_t samplesPerWindow = (size_t)(powf(10, windowExponent) + 0.5f);
+    samplesPerWindow -= samplesPerWindow % channels;
+    samplesPerWindow = (samplesPerWindow) ? samplesPerWindow : channels;
+    float delta = screenWidth / (float)samplesPerWindow;
+    size_t const frames = samplesPerWindow / channels;
+    if (IsKeyPressed(KEY_LEFT)) {
+      panFrames += frames / PAN_STEP_DIVIDER + 1;
+    }
+    if (IsKeyPressed(KEY_RIGHT)) {
+      panFrames -= frames / PAN_STEP_DIVIDER + 1;
+    }
+    if (IsMouseButtonDown(MOUSE_BUTTON_LEFT) && GetMousePosition().y > 160) {
+      panFrames += (int64_t)(GetMouseDelta().x * frames / screenWidth);
+    }
+
+    acquisitionArgs.windowFrames = frames;
+    acquisitionArgs.triggerMode = triggerMode;
+    acquisitionArgs.triggerPosition = triggerPosition;
+    acquisitionArgs.trigger.type = triggerType;
+    acquisitionArgs.trigger.slope = triggerSlope;
+    acquisitionArgs.trigger.level = triggerLevel;
+    uint64_t const preTrigger = (uint64_t)(triggerPosition * frames);
+
+    // Panning moves back from the live window into the memory.
+    uint64_t oldest;
+    uint64_t const newest = DeepMemory_range(memory, &oldest);
+    bool const freeRun =
+        followLiveView(&live, &acquisitionArgs, newest, frames, GetTime());
+    uint64_t const shownSpectra = spectrumArgs.spectra;
+    uint64_t const liveEnd = live.liveEnd;
+    acquisitionArgs.yMin = yMin;
+    acquisitionArgs.yMax = yMax;
+    bool const persistStale = !acquisitionArgs.persist ||
+                              persistYMin != yMin || persistYMax != yMax ||
+                              persistSamples != samplesPerWindow;
+    if (persist && persistStale) {
+      Persistence_clear(acquisitionArgs.persistence);
+      persistYMin = yMin;
+      persistYMax = yMax;
+      persistSamples = samplesPerWindow;
+    }
+    acquisitionArgs.persist = persist;
+    if (persist && persistDecay > 0) {
+      Persistence_decay(acquisitionArgs.persistence,
+                        expf(-GetFrameTime() / persistDecay));
+    }
+    // Eye and constellation maps are built in the acquisition thread from
+    // the full stream, they restart when shown or rescaled.
+    bool const mapStale = acquisitionArgs.display != display ||
+                          mapYMin != yMin || mapYMax != yMax;
+    Persistence *map = NULL;
+    if (display == DISPLAY_EYE) {
+      map = acquisitionArgs.eye->map;
+      if (mapStale) {
+        EyeDiagram_reset(acquisitionArgs.eye);
+      }
+    } else if (display == DISPLAY_XY) {
+      map = acquisitionArgs.constellation->map;
+      if (mapStale) {
+        Constellation_reset(acquisitionArgs.constellation);
+      }
+    } else if (display == DISPLAY_FFT && mapStale) {
+      Spectrum_reset(spectrumArgs.spectrum);
+    } else if (display == DISPLAY_WATERFALL && mapStale) {
+      Waterfall_clear(spectrumArgs.waterfall);
+    }
+    spectrumArgs.history = display == DISPLAY_WATERFALL;
+    Spectrum_configure(spectrumArgs.spectrum, (size_t)1 << fftOrder,
+                       fftWindow, fftAverage, fftAverages);
+    mapYMin = yMin;
+    mapYMax = yMax;
+    acquisitionArgs.eye->threshold = triggerLevel;
+    acquisitionArgs.display = display;
+    if (map && persistDecay > 0) {
+      Persistence_decay(map, expf(-GetFrameTime() / persistDecay));
+    }
+    int64_t const maxPan = (int64_t)(liveEnd - oldest) - (int64_t)frames;
+    panFrames = (panFrames > maxPan) ? maxPan : panFrames;
+    panFrames = (panFrames < 0) ? 0 : panFrames;
+    uint64_t const viewEnd = liveEnd - panFrames;
+    bool const viewValid = viewEnd >= oldest + frames;
+
+    // More than one frame per pixel column: reduce to a fixed number of
+    // points per column so the vertex count stays constant. Peak detect
+    // reads the memory pyramid, so its cost does not depend on the window.
+    bool const decimate = frames > (size_t)screenWidth;
+    bool const pyramid = decimateMode == DECIMATE_PEAK ||
+                         samplesPerWindow > RAW_REDUCE_MAX_SAMPLES;
+    // Interpolation pays off once a sample spans more than a pixel column.
+    bool const interpolate = sinc && frames < (size_t)screenWidth;
+    bool const rolling = roll && display == DISPLAY_YT && !persist;
+    bool const averaging = averageMode != WAVEFORM_AVERAGE_OFF &&
+                           display == DISPLAY_YT && !persist && !rolling;
+    bool const enveloping = envelope && display == DISPLAY_YT && !persist &&
+                            !rolling;
+    WaveformAverage_configure(acquisitionArgs.average, averageMode,
+                              averageCount);
+    bool const realigned = alignPosition != triggerPosition ||
+                           alignLevel != triggerLevel ||
+                           alignSamples != samplesPerWindow;
+    if (averaging && (!acquisitionArgs.averaging || realigned)) {
+      WaveformAverage_reset(acquisitionArgs.average);
+    }
+    if (enveloping &&
+        (!acquisitionArgs.enveloping || realigned || envelopeCleared)) {
+      Envelope_reset(acquisitionArgs.envelope);
+    }
+    alignPosition = triggerPosition;
+    alignLevel = triggerLevel;
+    alignSamples = samplesPerWindow;
+    acquisitionArgs.averaging = averaging;
+    acquisitionArgs.enveloping = enveloping;
+    envelopePoints = (enveloping)
+                         ? Envelope_read(acquisitionArgs.envelope, envelopeMin,
+                                         envelopeMax, &envelopeCount)
+                         : 0;
+    bool const segmented = display == DISPLAY_SEGMENTS;
+    if (segmented && (!segmentsShown || armedCount != segmentCount ||
+                      armedFrames != frames)) {
+      segmentsArmed = samplesPerWindow <= MAX_WINDOW_SAMPLES &&
+                      Segments_arm(segments, segmentCount, frames);
+      acquisitionArgs.droppedTriggers = 0;
+      armedCount = segmentCount;
+      armedFrames = frames;
+      segmentNumber = 1;
+      overlaidCount = 0;
+      Persistence_clear(segmentMap);
+    }
+    segmentsShown = segmented;
+    acquisitionArgs.segmenting = segmented && segmentsArmed;
+    if (segmented) {
+      // The stored segments replace the memory view.
+      segmentsFilled =
+          (acquisitionArgs.segmenting) ? Segments_filled(segments) : 0;
+      if (segmentView == SEGMENT_VIEW_PLAY && segmentsFilled &&
+          GetTime() - segmentPlayTime > SEGMENT_PLAY_PERIOD_S) {
+        segmentNumber = segmentNumber % segmentsFilled + 1;
+        segmentPlayTime = GetTime();
+      }
+      segmentNumber = ((size_t)segmentNumber > segmentsFilled)
+                          ? (int)segmentsFilled
+                          : segmentNumber;
+      segmentNumber = (segmentNumber < 1) ? 1 : segmentNumber;
+      segmentValid = false;
+      comparePoints = 0;
+      if (segmentView == SEGMENT_VIEW_ALL) {
+        // Only the segments stored since the last frame are drawn in.
+        if (overlayYMin != yMin || overlayYMax != yMax) {
+          Persistence_clear(segmentMap);
+          overlaidCount = 0;
+          overlayYMin = yMin;
+          overlayYMax = yMax;
+        }
+        for (; overlaidCount < segmentsFilled; overlaidCount++) {
+          Segments_read(segments, overlaidCount, internalBuffer, NULL);
+          Persistence_accumulate(segmentMap, internalBuffer, frames,
+                                 channels, yMin, yMax);
+        }
+      } else {
+        segmentValid = Segments_read(segments, segmentNumber - 1,
+                                     internalBuffer, &segmentStamp);
+        previousStamp = segmentStamp;
+        if (segmentNumber > 1) {
+          Segments_read(segments, segmentNumber - 2, NULL, &previousStamp);
+        }
+      }
+      if (segmentValid && decimate) {
+        Decimate_minMax(internalBuffer, frames, channels, screenWidth,
+                        columnMin, columnMax);
+      }
+      if (segmentValid && segmentView == SEGMENT_VIEW_REFERENCE) {
+        // The band between the first segment and the shown one, in the
+        // envelope buffers: there is no envelope outside of YT.
+        float *const reference =
+            (decimate) ? internalBuffer : internalBuffer + samplesPerWindow;
+        Segments_read(segments, 0, reference, NULL);
+        float const *lower = internalBuffer;
+        float const *upper = internalBuffer;
+        if (decimate) {
+          Decimate_minMax(reference, frames, channels, screenWidth,
+                          envelopeMin, envelopeMax);
+          lower = columnMin;
+          upper = columnMax;
+        } else {
+          memcpy(envelopeMin, reference, samplesPerWindow * sizeof(float));
+          memcpy(envelopeMax, reference, samplesPerWindow * sizeof(float));
+        }
+        comparePoints = (decimate) ? (size_t)screenWidth : frames;
+        for (size_t i = 0; i < comparePoints * channels; i++) {
+          envelopeMin[i] = fminf(envelopeMin[i], lower[i]);
+          envelopeMax[i] = fmaxf(envelopeMax[i], upper[i]);
+        }
+      }
+      // internalBuffer no longer holds the memory view.
+      reducedSamples = 0;
+    } else if (rolling) {
+      // Columns are aligned on absolute frames, so the ones already drawn
+      // never change: only those completed since the last frame are reduced
+      // and uploaded, a single pixel column each.
+      size_t const columnFrames =
+          (frames > (size_t)screenWidth) ? frames / screenWidth : 1;
+      uint64_t const end = newest / columnFrames;
+      uint64_t const begin = (oldest + columnFrames - 1) / columnFrames;
+      if (columnFrames != rollFrames || yMin != rollYMin ||
+          yMax != rollYMax || end < rollEnd ||
+          end - rollEnd > (uint64_t)screenWidth) {
+        RollChart_clear(rollChart);
+        UpdateTexture(rollTexture, rollChart->pixels);
+        rollEnd = (end > (uint64_t)screenWidth) ? end - screenWidth : 0;
+        rollEnd = (rollEnd > begin) ? rollEnd : begin;
+        rollFrames = columnFrames;
+        rollYMin = yMin;
+        rollYMax = yMax;
+      }
+      size_t const count = (end > rollEnd) ? end - rollEnd : 0;
+      if (count && !DeepMemory_reduce(memory, rollEnd * columnFrames,
+                                      count * columnFrames, count, columnMin,
+                                      columnMax)) {
+        // Overwritten since the range was read, start over next frame.
+        rollFrames = 0;
+      } else if (count) {
+        for (size_t i = 0; i < count; i++) {
+          size_t const x = (rollEnd + i) % screenWidth;
+          uint8_t const *const column =
+              RollChart_draw(rollChart, x, columnMin + i * channels,
+                             columnMax + i * channels, yMin, yMax);
+          UpdateTextureRec(rollTexture, (Rectangle){x, 0, 1, screenHeight},
+                           column);
+        }
+        rollEnd = end;
+      }
+      // columnMin and columnMax no longer hold the reduced view.
+      reducedSamples = 0;
+    } else if (averaging) {
+      // The mean of the triggered windows replaces the memory view.
+      averageValid =
+          WaveformAverage_read(acquisitionArgs.average, internalBuffer,
+                               MAX_WINDOW_SAMPLES, &averagedCount) ==
+          samplesPerWindow;
+      if (averageValid && interpolate) {
+        sincCount = Interpolator_run(interpolator, internalBuffer, frames,
+                                     channels, 0, frames, sincBuffer);
+      } else if (averageValid && decimate &&
+                 decimateMode == DECIMATE_LTTB) {
+        Decimate_lttb(internalBuffer, frames, channels, screenWidth, lttbX,
+                      lttbY);
+      } else if (averageValid && decimate && decimateMode == DECIMATE_RMS) {
+        Decimate_rms(internalBuffer, frames, channels, screenWidth, columnMin,
+                     columnMax);
+      } else if (averageValid && decimate) {
+        Decimate_minMax(internalBuffer, frames, channels, screenWidth,
+                        columnMin, columnMax);
+      }
+      // internalBuffer no longer holds the memory view.
+      reducedSamples = 0;
+    } else if (viewValid && (reducedEnd != viewEnd ||
+                      reducedSamples != samplesPerWindow ||
+                      reducedMode != decimateMode ||
+                      reducedSinc != interpolate)) {
+      uint64_t const viewBegin = viewEnd - frames;
+      // Fails when the acquisition overwrote the start of the view since
+      // the range was read: the previous view is kept and this one retried.
+      bool fetched;
+      if (interpolate) {
+        // Neighbouring frames, when stored, keep the filter exact up to the
+        // screen edges.
+        uint64_t const margin = INTERPOLATE_TAPS / 2;
+        uint64_t const copyBegin =
+            (viewBegin > oldest + margin) ? viewBegin - margin : oldest;
+        uint64_t const copyEnd =
+            (viewEnd + margin < newest) ? viewEnd + margin : newest;
+        fetched = DeepMemory_copy(memory, copyBegin, copyEnd - copyBegin,
+                                  internalBuffer);
+        sincCount = (fetched) ? Interpolator_run(interpolator, internalBuffer,
+                                                 copyEnd - copyBegin, channels,
+                                                 viewBegin - copyBegin, frames,
+                                                 sincBuffer)
+                              : sincCount;
+      } else if (decimate && pyramid) {
+        fetched = DeepMemory_reduce(memory, viewBegin, frames, screenWidth,
+                                    columnMin, columnMax);
+      } else {
+        fetched = DeepMemory_copy(memory, viewBegin, frames, internalBuffer);
+      }
+      if (fetched && decimate && !pyramid && decimateMode == DECIMATE_LTTB) {
+        Decimate_lttb(internalBuffer, frames, channels, screenWidth, lttbX,
+                      lttbY);
+      } else if (fetched && decimate && !pyramid) {
+        Decimate_rms(internalBuffer, frames, channels, screenWidth, columnMin,
+                     columnMax);
+      }
+      if (fetched) {
+        reducedEnd = viewEnd;
+        reducedSamples = samplesPerWindow;
+        reducedMode = decimateMode;
+        reducedSinc = interpolate;
+      }
+    }
     //   Draw
     BeginDrawing();
 
     ClearBackground(RAYWHITE);
 
-    GuiSpinner((Rectangle){680, 40, 105, 20}, "yMax ", &yMax, -50, 50, false);
-    GuiSpinner((Rectangle){680, 70, 105, 20}, "yMin ", &yMin, -50, 50, false);
+    GuiSpinner((Rectangle){680, 40, 105, 20}, "yMax ", &yMax, -Y_LIMIT,
+               Y_LIMIT, false);
+    GuiSpinner((Rectangle){680, 70, 105, 20}, "yMin ", &yMin, -Y_LIMIT,
+               Y_LIMIT, false);
+    autosetPressed = GuiButton((Rectangle){680, 100, 105, 20}, "AUTOSET");
+    GuiToggle((Rectangle){680, 130, 105, 20}, "AUTO RANGE", &autoRange);
     GuiSlider((Rectangle){110, 40, 105, 20}, "SamplesPerWindow", NULL,
-              &samplesPerWindow, 1,
-              MAX_SCREEN_DATA_SIZE / (float)sizeof(float));
+              &windowExponent, 0, maxWindowExponent);
     int samplesPerWindowGuiValue = (int)samplesPerWindow;
-    GuiValueBox((Rectangle){220, 40, 50, 20}, NULL, &samplesPerWindowGuiValue,
-                1, MAX_SCREEN_DATA_SIZE / sizeof(float), false);
+    GuiValueBox((Rectangle){220, 40, 80, 20}, NULL, &samplesPerWindowGuiValue,
+                1, INT32_MAX, false);
+    GuiComboBox((Rectangle){110, 70, 105, 20}, "PEAK;LTTB;RMS",
+                &decimateMode);
+    GuiToggle((Rectangle){220, 70, 80, 20}, "PERSIST", &persist);
+    GuiComboBox((Rectangle){305, 70, 75, 20}, "YT;EYE;XY;FFT;WFALL;SEG",
+                &display);
+    GuiSpinner((Rectangle){290, 130, 80, 20}, "FFT 2^", &fftOrder, 8, 20,
+               false);
+    GuiComboBox((Rectangle){375, 130, 80, 20}, "HANN;BH;FLATTOP",
+                &fftWindow);
+    GuiComboBox((Rectangle){460, 130, 80, 20}, "NONE;LINEAR;PEAK;MAX",
+                &fftAverage);
+    // Only write back on a click, SINGLE may stop acquisition meanwhile.
+    bool const wasRunning = acquisitionArgs.running;
+    bool running = wasRunning;
+    GuiToggle((Rectangle){320, 40, 60, 20}, (running) ? "STOP" : "RUN",
+              &running);
+    running = (runPressed) ? !running : running;
+    if (running != wasRunning) {
+      if (running && acquisitionArgs.segmenting) {
+        // Emptied before acquisition resumes, full segments would stop it
+        // again at the first trigger.
+        Segments_arm(segments, segmentCount, frames);
+        acquisitionArgs.droppedTriggers = 0;
+        segmentNumber = 1;
+        overlaidCount = 0;
+        Persistence_clear(segmentMap);
+      }
+      acquisitionArgs.running = running;
+    }
+    GuiComboBox((Rectangle){110, 100, 105, 20}, "AUTO;NORMAL;SINGLE",
+                &triggerMode);
+    GuiComboBox((Rectangle){220, 100, 80, 20}, "RISE;FALL;BOTH",
+                &triggerSlope);
+    GuiSlider((Rectangle){360, 100, 105, 20}, "Level", NULL, &triggerLevel,
+              yMin, yMax);
+    GuiSlider((Rectangle){540, 100, 105, 20}, "Position", NULL,
+              &triggerPosition, 0, 1);
+    GuiComboBox((Rectangle){110, 130, 105, 20},
+                "EDGE;WIDTH;RUNT;WINDOW;SLEW;PATTERN", &triggerType);
+    GuiToggle((Rectangle){545, 130, 60, 20}, "ROLL", &roll);
+    GuiToggle((Rectangle){610, 130, 60, 20}, "SINC", &sinc);
+    if (display == DISPLAY_YT) {
+      GuiComboBox((Rectangle){390, 70, 80, 20}, "AVG OFF;AVG EXP;AVG BOX",
+                  &averageMode);
+      GuiSpinner((Rectangle){500, 70, 80, 20}, "N ", &averageCount, 2,
+                 WAVEFORM_AVERAGE_MAX_COUNT, false);
+      GuiToggle((Rectangle){590, 70, 40, 20}, "ENV", &envelope);
+      envelopeCleared = GuiButton((Rectangle){635, 70, 35, 20}, "CLR");
+    } else if (display == DISPLAY_SEGMENTS) {
+      GuiSpinner((Rectangle){425, 70, 75, 20}, "SEGS ", &segmentCount, 1,
+                 SEGMENTS_MAX_COUNT, false);
+      GuiSpinner((Rectangle){520, 70, 75, 20}, "# ", &segmentNumber, 1,
+                 (segmentsFilled) ? (int)segmentsFilled : 1, false);
+      GuiComboBox((Rectangle){600, 70, 70, 20}, "STEP;PLAY;ALL;REF",
+                  &segmentView);
+    }
+    char const *const acquired =
+        (averaging) ? TextFormat(", %zu acq.", averagedCount)
+        : (enveloping) ? TextFormat(", %zu acq.", envelopeCount)
+                       : "";
+    // Segmented bursts longer than the trigger queue lose triggers.
+    uint64_t const droppedTriggers = acquisitionArgs.droppedTriggers;
+    char const *const dropped =
+        (droppedTriggers)
+            ? TextFormat(", %llu dropped", (unsigned long long)droppedTriggers)
+            : "";
+    if (segmented && segmentValid) {
+      // Trigger to trigger distance in frames, store time of day.
+      struct tm day;
+      localtime_r(&segmentStamp.time.tv_sec, &day);
+      GuiLabel((Rectangle){390, 40, 280, 20},
+               TextFormat("seg %d/%zu, +%llu frames, %02d:%02d:%02d.%03ld%s",
+                          segmentNumber, segmentsFilled,
+                          (unsigned long long)(segmentStamp.trigger -
+                                               previousStamp.trigger),
+                          day.tm_hour, day.tm_min, day.tm_sec,
+                          segmentStamp.time.tv_nsec / 1000000, dropped));
+    } else if (segmented) {
+      GuiLabel((Rectangle){390, 40, 280, 20},
+               (segmentsArmed)
+                   ? TextFormat("%zu/%d segments%s", segmentsFilled,
+                                segmentCount, dropped)
+                   : "segments do not fit in memory");
+    } else {
+      GuiLabel((Rectangle){390, 40, 280, 20},
+               TextFormat("view -%llu / %llu frames%s",
+                          (unsigned long long)panFrames,
+                          (unsigned long long)(newest - oldest), acquired));
+    }
 
-    renderFunc(internalBuffer, screen_data_size / sizeof(float), delta,
-               screenWidth, screenHeight, yMin, yMax);
+    if (envelopePoints > 1) {
+      // Behind the trace. Reduced envelopes have one point per column.
+      bool const perFrame = envelopePoints == frames;
+      renderEnvelope(envelopeMin, envelopeMax, envelopePoints, channels,
+                     screenWidth / (float)envelopePoints,
+                     (perFrame) ? delta : 0, screenHeight, yMin, yMax);
+    }
+    if (acquisitionArgs.display == DISPLAY_EYE) {
+      EyeMeasurement eye;
+      EyeDiagram_measure(acquisitionArgs.eye, &eye);
+      GuiLabel((Rectangle){390, 70, 280, 20},
+               (eye.locked) ? TextFormat("UI %.2f frames, height %.3f, "
+                                         "width %.2f UI",
+                                         eye.ui, eye.height, eye.width)
+                            : "no symbol clock");
+      Persistence_render(acquisitionArgs.eye->map, persistPixels);
+      UpdateTexture(persistTexture, persistPixels);
+      DrawTexture(persistTexture, 0, 0, WHITE);
+    } else if (acquisitionArgs.display == DISPLAY_FFT) {
+      uint64_t const spectra =
+          Spectrum_read(spectrumArgs.spectrum, screenWidth, spectrumDb);
+      GuiLabel((Rectangle){390, 70, 280, 20},
+               TextFormat("%d pts, %llu spectra, %.0f to %.0f dB",
+                          1 << fftOrder, (unsigned long long)spectra,
+                          SPECTRUM_DB_MIN, SPECTRUM_DB_MAX));
+      if (spectra) {
+        renderSpectrum(spectrumDb, screenWidth, screenWidth, screenHeight,
+                       SPECTRUM_DB_MIN, SPECTRUM_DB_MAX);
+      }
+    } else if (acquisitionArgs.display == DISPLAY_WATERFALL) {
+      GuiLabel((Rectangle){390, 70, 280, 20},
+               TextFormat("%d pts, %.0f to %.0f dB", 1 << fftOrder,
+                          SPECTRUM_DB_MIN, SPECTRUM_DB_MAX));
+      while (Waterfall_fetch(spectrumArgs.waterfall, &waterfallSeen,
+                             waterfallLine, &waterfallNewest)) {
+        Rectangle const line = {0, waterfallNewest, screenWidth, 1};
+        UpdateTextureRec(waterfallTexture, line, waterfallLine);
+      }
+      // Newest row at the top: the ring from it down, then its wrapped
+      // start. Scrolling only moves this split.
+      float const split = waterfallRows - waterfallNewest;
+      DrawTextureRec(waterfallTexture,
+                     (Rectangle){0, waterfallNewest, screenWidth, split},
+                     (Vector2){0, waterfallTop}, WHITE);
+      DrawTextureRec(waterfallTexture,
+                     (Rectangle){0, 0, screenWidth, waterfallNewest},
+                     (Vector2){0, waterfallTop + split}, WHITE);
+    } else if (acquisitionArgs.display == DISPLAY_XY && channels < 2) {
+      GuiLabel((Rectangle){390, 70, 280, 20}, "XY needs complex data");
+    } else if (acquisitionArgs.display == DISPLAY_XY) {
+      // Square map centered on screen, I horizontal and Q vertical.
+      Rectangle const square = {0, 0, screenHeight, screenHeight};
+      Persistence_render(acquisitionArgs.constellation->map, persistPixels);
+      UpdateTextureRec(persistTexture, square, persistPixels);
+      DrawTextureRec(persistTexture, square,
+                     (Vector2){(screenWidth - screenHeight) / 2.0f, 0}, WHITE);
+    } else if (segmented && segmentView == SEGMENT_VIEW_ALL) {
+      Persistence_render(segmentMap, persistPixels);
+      UpdateTexture(persistTexture, persistPixels);
+      DrawTexture(persistTexture, 0, 0, WHITE);
+    } else if (segmented) {
+      if (comparePoints > 1) {
+        renderEnvelope(envelopeMin, envelopeMax, comparePoints, channels,
+                       screenWidth / (float)comparePoints,
+                       (decimate) ? 0 : delta, screenHeight, yMin, yMax);
+      }
+      if (segmentValid && decimate) {
+        renderPeakDetect(columnMin, columnMax, screenWidth, channels,
+                         screenWidth, screenHeight, yMin, yMax);
+      } else if (segmentValid) {
+        renderFunc(internalBuffer, samplesPerWindow, delta, screenWidth,
+                   screenHeight, yMin, yMax);
+      }
+    } else if (acquisitionArgs.persist) {
+      Persistence_render(acquisitionArgs.persistence, persistPixels);
+      UpdateTexture(persistTexture, persistPixels);
+      DrawTexture(persistTexture, 0, 0, WHITE);
+    } else if (rolling) {
+      // Oldest column on the left edge, the newest one on the right edge.
+      float const newestX = (rollEnd + screenWidth - 1) % screenWidth;
+      float const older = screenWidth - 1 - newestX;
+      DrawTextureRec(rollTexture,
+                     (Rectangle){newestX + 1, 0, older, screenHeight},
+                     (Vector2){0, 0}, WHITE);
+      DrawTextureRec(rollTexture,
+                     (Rectangle){0, 0, newestX + 1, screenHeight},
+                     (Vector2){older, 0}, WHITE);
+    } else if (averaging && !averageValid) {
+      // Nothing averaged yet for this window.
+    } else if (decimate && (averaging || !pyramid) &&
+               decimateMode == DECIMATE_LTTB) {
+      renderDecimated(lttbX, lttbY, screenWidth, channels, frames, screenWidth,
+                      screenHeight, yMin, yMax);
+    } else if (decimate) {
+      renderPeakDetect(columnMin, columnMax, screenWidth, channels,
+                       screenWidth, screenHeight, yMin, yMax);
+    } else if (interpolate && (viewValid || averaging)) {
+      renderInterpolated(sincBuffer, sincCount, channels,
+                         screenWidth / (float)(frames * sincPoints), delta,
+                         screenHeight, yMin, yMax);
+    } else {
+      renderFunc(internalBuffer, samplesPerWindow, delta, screenWidth,
+                 screenHeight, yMin, yMax);
+    }
+    if (!freeRun && !rolling && acquisitionArgs.display == DISPLAY_YT) {
+      float const levelY =
+          screenHeight * (1 - (triggerLevel - yMin) / (yMax - yMin));
+      float const triggerX =
+          (preTrigger + panFrames) * (screenWidth / (float)frames);
+      DrawLine(triggerX, 160, triggerX, screenHeight, ORANGE);
+      if (triggerType == TRIGGER_TYPE_RUNT ||
+          triggerType == TRIGGER_TYPE_WINDOW ||
+          triggerType == TRIGGER_TYPE_SLEW) {
+        float const low = acquisitionArgs.trigger.low;
+        float const high = acquisitionArgs.trigger.high;
+        float const lowY = screenHeight * (1 - (low - yMin) / (yMax - yMin));
+        float const highY = screenHeight * (1 - (high - yMin) / (yMax - yMin));
+        DrawLine(0, lowY, screenWidth, lowY, ORANGE);
+        DrawLine(0, highY, screenWidth, highY, ORANGE);
+      } else {
+        DrawLine(0, levelY, screenWidth, levelY, ORANGE);
+      }
+    }
 
     EndDrawing();
+
+    // Event pacing: nothing changes on screen until new frames are stored,
+    // a trigger fires, a spectrum is computed, the AUTO timeout expires or
+    // the user acts, so sleep on the memory until one of them happens.
+    // Fading maps keep redrawing.
+    bool const animating =
+        ((persist || display == DISPLAY_EYE || display == DISPLAY_XY) &&
+         persistDecay > 0) ||
+        (display == DISPLAY_SEGMENTS && segmentView == SEGMENT_VIEW_PLAY);
+    bool const spectral =
+        display == DISPLAY_FFT || display == DISPLAY_WATERFALL;
+    while (pacing == PACING_EVENTS && !animating && !WindowShouldClose()) {
+      if (DeepMemory_wait(memory, newest, PACING_POLL_NS) != newest ||
+          acquisitionArgs.triggerCount != live.shownTriggerCount ||
+          (spectral && spectrumArgs.spectra != shownSpectra)) {
+        break;
+      }
+      if (!freeRun && triggerMode == TRIGGER_MODE_AUTO &&
+          GetTime() - live.lastTriggerTime > AUTO_TRIGGER_TIMEOUT_S) {
+        break;
+      }
+      PollInputEvents();
+      if (inputPending()) {
+        break;
+      }
+    }
   }
 
+  free(internalBuffer);
+  free(columnMin);
+  free(columnMax);
+  free(lttbX);
+  free(lttbY);
+  free(spectrumDb);
+  free(envelopeMin);
+  free(envelopeMax);
+  Persistence_destroy(segmentMap);
+  Interpolator_destroy(interpolator);
+  free(sincBuffer);
+  UnloadTexture(rollTexture);
+  RollChart_destroy(rollChart);
+  UnloadTexture(waterfallTexture);
+  free(waterfallLine);
+  UnloadTexture(persistTexture);
+  free(persistPixels);
   CloseWindow(); // Close window and OpenGL context
 
   return 0;
@@ -109,13 +1216,20 @@ int main(int argc, char *argv[]) {
 
 void *recvTask(void *args) {
   int s = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
-  char const *const port = (char *)args;
+  UdpTaskArgs const *const udpArgs = (UdpTaskArgs *)args;
+  char const *const port = udpArgs->port;
   assert(s && "socket fail");
+  if (udpArgs->group) {
+    // Several scopes (and recorders) on one host may listen to the group.
+    int const reuse = 1;
+    setsockopt(s, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+  }
   struct addrinfo addrHints, *addrInfo;
   memset(&addrHints, 0, sizeof(addrHints));
   addrHints.ai_family = AF_INET;
   addrHints.ai_protocol = IPPROTO_UDP;
-  if (getaddrinfo("0.0.0.0", port, &addrHints, &addrInfo) != 0) {
+  char const *const bindAddr = (udpArgs->group) ? udpArgs->group : "0.0.0.0";
+  if (getaddrinfo(bindAddr, port, &addrHints, &addrInfo) != 0) {
     assert(0 && "getaddrinfo failed");
   };
   struct addrinfo *addr;
@@ -130,23 +1244,395 @@ void *recvTask(void *args) {
   freeaddrinfo(addrInfo);
   assert(addr && "bind failed");
   addr = NULL;
-  printf("[UDP] - waiting for data on port %s\n", port);
-  size_t const internalBufferSize = 32 * sizeof(float);
-  uint8_t internalBuffer[internalBufferSize];
+  if (udpArgs->group) {
+    struct ip_mreqn mreq;
+    memset(&mreq, 0, sizeof(mreq));
+    if (inet_pton(AF_INET, udpArgs->group, &mreq.imr_multiaddr) != 1) {
+      assert(0 && "invalid multicast group");
+    }
+    if (udpArgs->iface &&
+        inet_pton(AF_INET, udpArgs->iface, &mreq.imr_address) != 1) {
+      mreq.imr_ifindex = if_nametoindex(udpArgs->iface);
+      assert(mreq.imr_ifindex && "unknown interface");
+    }
+    if (setsockopt(s, IPPROTO_IP, IP_ADD_MEMBERSHIP, &mreq, sizeof(mreq)) != 0) {
+      assert(0 && "multicast join failed");
+    }
+    printf("[UDP] - joined group %s on interface %s\n", udpArgs->group,
+           (udpArgs->iface) ? udpArgs->iface : "any");
+  }
+  int const rcvBuf = UDP_RCVBUF_SIZE;
+  setsockopt(s, SOL_SOCKET, SO_RCVBUF, &rcvBuf, sizeof(rcvBuf));
+  bool gro = false;
+  if (udpArgs->gro) {
+    // Let the kernel coalesce segments of a flow into one big receive.
+    int const enable = 1;
+    gro = setsockopt(s, IPPROTO_UDP, UDP_GRO, &enable, sizeof(enable)) == 0;
+  }
+  printf("[UDP] - waiting for data on port %s (max datagram %zu bytes%s)\n",
+         port, udpArgs->maxDatagramSize, (gro) ? ", GRO" : "");
+  // With GRO one receive may hold many segments of up to maxDatagramSize.
+  size_t const internalBufferSize =
+      (gro) ? MAX_DATAGRAM_SIZE : udpArgs->maxDatagramSize;
+  uint8_t *internalBuffer = malloc(internalBufferSize);
+  assert(internalBuffer);
+  uint8_t control[CMSG_SPACE(sizeof(int))];
+  while (true) {
+    struct iovec iov = {.iov_base = internalBuffer,
+                        .iov_len = internalBufferSize};
+    struct msghdr msg = {.msg_iov = &iov,
+                         .msg_iovlen = 1,
+                         .msg_control = control,
+                         .msg_controllen = sizeof(control)};
+    ssize_t read = recvmsg(s, &msg, 0);
+    if (read < 0) {
+      assert(errno == EINTR && "receive failed");
+      continue;
+    }
+    if (msg.msg_flags & MSG_TRUNC) {
+      printf("[UDP] - datagram truncated to %zd bytes\n", read);
+    }
+    size_t segmentSize = read;
+    for (struct cmsghdr *c = CMSG_FIRSTHDR(&msg); c; c = CMSG_NXTHDR(&msg, c)) {
+      if (c->cmsg_level == IPPROTO_UDP && c->cmsg_type == UDP_GRO) {
+        int gsoSize;
+        memcpy(&gsoSize, CMSG_DATA(c), sizeof(gsoSize));
+        segmentSize = gsoSize;
+      }
+    }
+    // Each coalesced segment is one producer datagram: drop the partial
+    // sample at the end of each one so samples stay aligned. Segments over
+    // the limit are truncated like datagrams are without GRO.
+    if (gro && segmentSize > udpArgs->maxDatagramSize) {
+      printf("[UDP] - datagram truncated to %zu bytes\n",
+             udpArgs->maxDatagramSize);
+    }
+    for (size_t offset = 0; offset < (size_t)read; offset += segmentSize) {
+      size_t size = (size_t)read - offset;
+      size = (size < segmentSize) ? size : segmentSize;
+      size = (size < udpArgs->maxDatagramSize) ? size
+                                               : udpArgs->maxDatagramSize;
+      writeSamples(internalBuffer + offset, size - size % sizeof(float));
+    }
+  }
+  free(internalBuffer);
+  return NULL;
+}
+
+void writeSamples(uint8_t const *const samples, size_t const size) {
+  // IOBuffer rejects writes bigger than itself, split large datagrams.
+  size_t const chunkSize = data->bufferSize / 2;
+  for (size_t offset = 0; offset < size; offset += chunkSize) {
+    size_t const left = size - offset;
+    IOBuffer_write(data, samples + offset, (left < chunkSize) ? left : chunkSize);
+  }
+  return;
+}
+
+void *shmTask(void *args) {
+  char const *const name = (char *)args;
+  struct timespec const attachPeriod = {.tv_nsec = SHM_ATTACH_PERIOD_NS};
+  struct timespec const pollPeriod = {.tv_nsec = INGEST_POLL_PERIOD_NS};
+  printf("[SHM] - waiting for segment %s\n", name);
+  while (true) {
+    ShmIngest *shm = ShmIngest_attach(name);
+    if (!shm) {
+      nanosleep(&attachPeriod, NULL);
+      continue;
+    }
+    printf("[SHM] - attached to %s\n", name);
+    while (true) {
+      BufferError err = ShmIngest_drain(shm, data);
+      if (err.errorCode == BUFFER_ERROR_EOF) {
+        break;
+      }
+      if (err.result == 0) {
+        nanosleep(&pollPeriod, NULL);
+      }
+    }
+    // Producer went away, wait for the next one to recreate the segment.
+    ShmIngest_detach(shm);
+    printf("[SHM] - producer closed %s\n", name);
+    nanosleep(&attachPeriod, NULL);
+  }
+  return NULL;
+}
+
+void *unixTask(void *args) {
+  char const *const path = (char *)args;
+  UnixIngest *unixIngest = UnixIngest_create(path);
+  assert(unixIngest && "unix socket setup failed");
+  printf("[UNIX] - waiting for producers on %s\n", path);
+  while (true) {
+    UnixIngest_poll(unixIngest, data, -1);
+  }
+  UnixIngest_destroy(unixIngest);
+  return NULL;
+}
+
+void *streamTask(void *args) {
+  StreamTaskArgs const *const streamArgs = (StreamTaskArgs *)args;
+  struct timespec const fullPeriod = {.tv_nsec = INGEST_POLL_PERIOD_NS};
+  while (true) {
+    int fd = STDIN_FILENO;
+    if (streamArgs->fifoPath) {
+      printf("[STREAM] - waiting for a writer on %s\n", streamArgs->fifoPath);
+      fd = open(streamArgs->fifoPath, O_RDONLY | O_CLOEXEC);
+      assert(fd >= 0 && "fifo open failed");
+    }
+    StreamIngest *stream =
+        StreamIngest_create(fd, streamArgs->format, streamArgs->sampleRate);
+    assert(stream);
+    while (true) {
+      BufferError err = StreamIngest_read(stream, data);
+      if (err.errorCode == BUFFER_ERROR_EOF) {
+        break;
+      }
+      if (err.errorCode == BUFFER_ERROR_DATA_DROPPED) {
+        // Buffer full: hold back the pipe instead of dropping samples.
+        nanosleep(&fullPeriod, NULL);
+      }
+    }
+    StreamIngest_destroy(stream);
+    if (!streamArgs->fifoPath) {
+      printf("[STREAM] - end of input\n");
+      IOBuffer_setEOF(data);
+      break;
+    }
+    // A FIFO reaches EOF whenever its writer exits, wait for the next one.
+    close(fd);
+  }
+  return NULL;
+}
+
+void *acquisitionTask(void *args) {
+  AcquisitionTaskArgs *const acquisition = (AcquisitionTaskArgs *)args;
+  size_t const frameBytes = acquisition->memory->channels * sizeof(float);
+  uint8_t *chunk = malloc(ACQUISITION_CHUNK_SIZE);
+  assert(chunk);
+  size_t const channels = acquisition->memory->channels;
+  size_t carry = 0;
+  uint64_t written = 0;
+  // Triggers whose window is not complete yet, oldest first. Outside of
+  // segmented acquisition holdoff keeps at most one.
+  uint64_t pending[TRIGGER_QUEUE];
+  size_t pendingFirst = 0;
+  size_t pendingCount = 0;
+  uint64_t sweep = 0; // Start of the next free running window to persist.
+  float *waveform = NULL;
+  size_t waveformFrames = 0;
+  while (true) {
+    BufferError err =
+        IOBuffer_read(data, chunk + carry, ACQUISITION_CHUNK_SIZE - carry);
+    if (err.errorCode == BUFFER_ERROR_EOF) {
+      break;
+    }
+    size_t const bytes = carry + err.result;
+    size_t const frames = bytes / frameBytes;
+    if (!acquisition->running) {
+      // Stopped: re-arm from scratch on the next RUN or SINGLE.
+      Trigger_reset(&acquisition->trigger);
+      EyeDiagram_resync(acquisition->eye);
+      Constellation_resync(acquisition->constellation);
+      Autoset_reset(acquisition->autoset);
+      pendingCount = 0;
+    } else {
+      uint64_t const firstFrame = written;
+      DeepMemory_write(acquisition->memory, (float *)chunk, frames);
+      written += frames;
+      Autoset_process(acquisition->autoset, (float *)chunk, frames, channels);
+      if (acquisition->display == DISPLAY_EYE) {
+        EyeDiagram_process(acquisition->eye, (float *)chunk, frames, channels,
+                           acquisition->yMin, acquisition->yMax);
+      } else {
+        EyeDiagram_resync(acquisition->eye);
+      }
+      if (acquisition->display == DISPLAY_FFT ||
+          acquisition->display == DISPLAY_WATERFALL) {
+        // Whole chunks only, a partial write would misalign frames. The
+        // spectrum skips ahead when it cannot keep up.
+        IOBuffer *const feed = acquisition->spectrumFeed;
+        size_t const space =
+            feed->bufferSize - 1 - IOBuffer_available(feed).result;
+        if (frames * frameBytes <= space) {
+          IOBuffer_write(feed, chunk, frames * frameBytes);
+        }
+      }
+      if (acquisition->display == DISPLAY_XY && channels >= 2) {
+        Constellation_process(acquisition->constellation, (float *)chunk,
+                              frames, channels, acquisition->yMin,
+                              acquisition->yMax);
+      } else {
+        Constellation_resync(acquisition->constellation);
+      }
+      size_t const window = acquisition->windowFrames;
+      uint64_t const preTrigger =
+          (uint64_t)(acquisition->triggerPosition * window);
+      uint64_t const postTrigger = window - preTrigger;
+      // The trigger re-arms only once the current window is complete,
+      // segmented acquisition re-arms at once and windows may overlap.
+      uint64_t const rearm = (acquisition->segmenting) ? 0 : postTrigger;
+      acquisition->trigger.holdoff =
+          (acquisition->holdoff > rearm) ? acquisition->holdoff : rearm;
+      while (acquisition->running) {
+        // An incomplete window does not stop the scan: the trigger state
+        // machines keep tracking the signal, holdoff prevents firing.
+        while (pendingCount &&
+               pending[pendingFirst] + postTrigger <= written &&
+               acquisition->running) {
+          uint64_t const trigger = pending[pendingFirst];
+          pendingFirst = (pendingFirst + 1) % TRIGGER_QUEUE;
+          pendingCount--;
+          acquisition->lastTrigger = trigger;
+          acquisition->triggerCount++;
+          if (acquisition->persist) {
+            persistWindow(acquisition, trigger - preTrigger, window,
+                          &waveform, &waveformFrames);
+          }
+          if (acquisition->averaging || acquisition->enveloping ||
+              acquisition->segmenting) {
+            collectWindow(acquisition, trigger, trigger - preTrigger, window,
+                          &waveform, &waveformFrames);
+          }
+          if (acquisition->triggerMode == TRIGGER_MODE_SINGLE) {
+            acquisition->running = false;
+          }
+        }
+        uint64_t trigger;
+        if (!acquisition->running ||
+            !Trigger_next(&acquisition->trigger, (float *)chunk, frames,
+                          channels, firstFrame, &trigger)) {
+          break;
+        }
+        // Not enough history yet for the pre-trigger part of the window.
+        if (trigger < preTrigger) {
+          continue;
+        }
+        if (pendingCount < TRIGGER_QUEUE) {
+          pending[(pendingFirst + pendingCount) % TRIGGER_QUEUE] = trigger;
+          pendingCount++;
+        } else {
+          acquisition->droppedTriggers++;
+        }
+      }
+      if (!acquisition->persist || !acquisition->freeRun) {
+        sweep = written;
+      }
+      while (sweep + window <= written) {
+        persistWindow(acquisition, sweep, window, &waveform, &waveformFrames);
+        sweep += window;
+      }
+    }
+    carry = bytes - frames * frameBytes;
+    memmove(chunk, chunk + frames * frameBytes, carry);
+  }
+  acquisition->ended = true;
+  free(chunk);
+  free(waveform);
+  return NULL;
+}
+
+void *spectrumTask(void *args) {
+  SpectrumTaskArgs *const spectrumArgs = (SpectrumTaskArgs *)args;
+  size_t const frameBytes = spectrumArgs->channels * sizeof(float);
+  uint8_t *chunk = malloc(SPECTRUM_CHUNK_SIZE);
+  Waterfall *const waterfall = spectrumArgs->waterfall;
+  float *rowDb = calloc(waterfall->width, sizeof(float));
+  assert(chunk && rowDb);
+  size_t carry = 0;
   while (true) {
-    size_t read = recv(s, &internalBuffer, sizeof(internalBuffer), 0);
-    // printf("[UDP] - recv %lu bytes\n", read);
-    assert(read % sizeof(float) == 0 && "receive failed");
-    BufferError err = IOBuffer_write(data, internalBuffer, read);
-    // if (err.errorCode == BUFFER_ERROR_OK) {
-    //   printf("recv %lu bytes\n", err.result);
-    // } else {
-    //   printf("ERROR %d\n", err.errorCode);
-    // }
+    BufferError err = IOBuffer_read(spectrumArgs->feed, chunk + carry,
+                                    SPECTRUM_CHUNK_SIZE - carry);
+    if (err.errorCode == BUFFER_ERROR_EOF) {
+      break;
+    }
+    size_t const bytes = carry + err.result;
+    size_t const frames = bytes / frameBytes;
+    // One call per completed block, so each spectrum can become a row.
+    for (size_t done = 0; done < frames;) {
+      size_t consumed;
+      bool transformed;
+      float const *const src = (float *)chunk + done * spectrumArgs->channels;
+      if (!Spectrum_process(spectrumArgs->spectrum, src, frames - done,
+                            spectrumArgs->channels, &consumed,
+                            &transformed)) {
+        printf("[FFT] - spectrum allocation failed\n");
+      }
+      if (transformed && spectrumArgs->history) {
+        Spectrum_readLatest(spectrumArgs->spectrum, waterfall->width, rowDb);
+        Waterfall_push(waterfall, rowDb, SPECTRUM_DB_MIN, SPECTRUM_DB_MAX);
+      }
+      spectrumArgs->spectra += (transformed) ? 1 : 0;
+      done += consumed;
+    }
+    carry = bytes - frames * frameBytes;
+    memmove(chunk, chunk + frames * frameBytes, carry);
   }
+  free(chunk);
+  free(rowDb);
   return NULL;
 }
 
+float *copyWindow(DeepMemory *const memory, uint64_t const first,
+                  size_t const frames, float **const scratch,
+                  size_t *const scratchFrames) {
+  uint64_t oldest;
+  uint64_t const newest = DeepMemory_range(memory, &oldest);
+  if (first < oldest || first + frames > newest) {
+    return NULL;
+  }
+  if (*scratchFrames < frames) {
+    size_t const bytes = frames * memory->channels * sizeof(float);
+    float *grown = realloc(*scratch, bytes);
+    if (!grown) {
+      return NULL;
+    }
+    *scratch = grown;
+    *scratchFrames = frames;
+  }
+  return (DeepMemory_copy(memory, first, frames, *scratch)) ? *scratch : NULL;
+}
+
+void persistWindow(AcquisitionTaskArgs *const acquisition, uint64_t const first,
+                   size_t const frames, float **const scratch,
+                   size_t *const scratchFrames) {
+  DeepMemory *const memory = acquisition->memory;
+  float const *const window =
+      copyWindow(memory, first, frames, scratch, scratchFrames);
+  if (!window) {
+    return;
+  }
+  Persistence_accumulate(acquisition->persistence, window, frames,
+                         memory->channels, acquisition->yMin,
+                         acquisition->yMax);
+  return;
+}
+
+void collectWindow(AcquisitionTaskArgs *const acquisition,
+                   uint64_t const trigger, uint64_t const first,
+                   size_t const frames, float **const scratch,
+                   size_t *const scratchFrames) {
+  DeepMemory *const memory = acquisition->memory;
+  float const *const window =
+      copyWindow(memory, first, frames, scratch, scratchFrames);
+  if (!window) {
+    return;
+  }
+  if (acquisition->averaging) {
+    WaveformAverage_add(acquisition->average, window,
+                        frames * memory->channels);
+  }
+  if (acquisition->enveloping) {
+    Envelope_add(acquisition->envelope, window, frames);
+  }
+  // Like SINGLE, acquisition stops once every segment is full.
+  if (acquisition->segmenting &&
+      Segments_store(acquisition->segments, window, frames, trigger) == 0) {
+    acquisition->running = false;
+  }
+  return;
+}
+
 size_t decode_screen_data_size(float screen_data_size) {
   return ((int)screen_data_size >> 2) * 4;
 }
@@ -172,33 +1658,214 @@ int get_fps_from_argv(int argc, char *argv[], int const defaultVal) {
 
 char const *get_port_from_argv(int argc, char *argv[],
                                char const *const defaultVal) {
-  char const *port = defaultVal;
+  return get_option_from_argv(argc, argv, "-p", defaultVal);
+}
+
+char const *get_option_from_argv(int argc, char *argv[],
+                                 char const *const option,
+                                 char const *const defaultVal) {
+  char const *value = defaultVal;
   for (int i = 1; i < argc; i++) {
-    if (strcmp(argv[i], "-p") != 0) {
+    if (strcmp(argv[i], option) != 0) {
       continue;
     }
     if (i + 1 >= argc) {
       continue;
     }
-    port = argv[i + 1];
+    value = argv[i + 1];
     break;
   }
-  return port;
+  return value;
+}
+
+bool get_flag_from_argv(int argc, char *argv[], char const *const flag) {
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], flag) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+int get_choice_from_argv(int argc, char *argv[], char const *const option,
+                         char const *const *const choices, size_t const count,
+                         int const defaultVal) {
+  char const *value = get_option_from_argv(argc, argv, option, NULL);
+  if (!value) {
+    return defaultVal;
+  }
+  for (size_t i = 0; i < count; i++) {
+    if (strcmp(value, choices[i]) == 0) {
+      return (int)i;
+    }
+  }
+  return -1;
+}
+
+bool get_trigger_from_argv(int argc, char *argv[], Trigger *const trigger) {
+  Trigger_init(trigger);
+  trigger->hysteresis =
+      strtof(get_option_from_argv(argc, argv, "--trig-hyst", "0"), NULL);
+  trigger->low =
+      strtof(get_option_from_argv(argc, argv, "--trig-low", "-0.5"), NULL);
+  trigger->high =
+      strtof(get_option_from_argv(argc, argv, "--trig-high", "0.5"), NULL);
+  trigger->widthMin = strtoull(
+      get_option_from_argv(argc, argv, "--trig-width-min", "0"), NULL, 10);
+  char const *widthMax =
+      get_option_from_argv(argc, argv, "--trig-width-max", NULL);
+  if (widthMax) {
+    trigger->widthMax = strtoull(widthMax, NULL, 10);
+  }
+  char const *const types[] = {"edge", "width", "runt",
+                               "window", "slew", "pattern"};
+  char const *const widthConditions[] = {"less", "greater", "range"};
+  char const *const windowConditions[] = {"enter", "exit"};
+  char const *type = get_option_from_argv(argc, argv, "--trig-type", "edge");
+  char const *width = get_option_from_argv(argc, argv, "--trig-width", "less");
+  char const *window =
+      get_option_from_argv(argc, argv, "--trig-window", "enter");
+  int found = 0;
+  for (size_t i = 0; i < sizeof(types) / sizeof(types[0]); i++) {
+    if (strcmp(type, types[i]) == 0) {
+      trigger->type = (TriggerType)i;
+      found++;
+    }
+  }
+  for (size_t i = 0; i < sizeof(widthConditions) / sizeof(char *); i++) {
+    if (strcmp(width, widthConditions[i]) == 0) {
+      trigger->widthCondition = (TriggerWidthCondition)i;
+      found++;
+    }
+  }
+  for (size_t i = 0; i < sizeof(windowConditions) / sizeof(char *); i++) {
+    if (strcmp(window, windowConditions[i]) == 0) {
+      trigger->windowCondition = (TriggerWindowCondition)i;
+      found++;
+    }
+  }
+  // One character per channel, channel 0 first: '1', '0' or 'X'.
+  char const *pattern = get_option_from_argv(argc, argv, "--trig-pattern", "");
+  for (size_t ch = 0; pattern[ch] && ch < 8; ch++) {
+    if (pattern[ch] == '1' || pattern[ch] == '0') {
+      trigger->patternCare |= 1u << ch;
+      trigger->patternValue |= (uint8_t)((pattern[ch] == '1') << ch);
+    } else if (pattern[ch] != 'X' && pattern[ch] != 'x') {
+      return false;
+    }
+  }
+  return found == 3;
+}
+
+bool inputPending(void) {
+  Vector2 const mouse = GetMouseDelta();
+  return GetKeyPressed() != 0 || GetCharPressed() != 0 ||
+         GetMouseWheelMove() != 0 || mouse.x != 0 || mouse.y != 0 ||
+         IsMouseButtonPressed(MOUSE_BUTTON_LEFT) ||
+         IsMouseButtonReleased(MOUSE_BUTTON_LEFT) ||
+         IsMouseButtonDown(MOUSE_BUTTON_LEFT) || IsWindowResized();
+}
+
+void applyAutoset(AutosetEstimate const *const estimate, bool const gentle,
+                  size_t const channels, float const maxWindowExponent,
+                  int *const yMin, int *const yMax,
+                  float *const windowExponent, float *const triggerLevel) {
+  float const peakToPeak = estimate->max - estimate->min;
+  float const margin = peakToPeak * AUTOSET_MARGIN;
+  int newMax = (int)ceilf(estimate->max + margin);
+  int newMin = (int)floorf(estimate->min - margin);
+  newMax = (newMax > newMin) ? newMax : newMin + 1;
+  newMax = (newMax < Y_LIMIT) ? newMax : Y_LIMIT;
+  newMin = (newMin > -Y_LIMIT) ? newMin : -Y_LIMIT;
+  newMin = (newMin < newMax) ? newMin : newMax - 1;
+  // Integer scale steps: a clipped signal always rescales, a small one only
+  // when it uses too little of the screen, which cannot oscillate.
+  bool const clipped = estimate->max > *yMax || estimate->min < *yMin;
+  bool const small = peakToPeak < (*yMax - *yMin) * AUTORANGE_MIN_FILL;
+  if (!gentle || clipped || small) {
+    *yMax = newMax;
+    *yMin = newMin;
+  }
+  *triggerLevel = (estimate->max + estimate->min) / 2;
+  if (estimate->period > 0) {
+    float exponent =
+        log10f((float)(estimate->period * AUTOSET_PERIODS * channels));
+    exponent = (exponent > 0) ? exponent : 0;
+    exponent = (exponent < maxWindowExponent) ? exponent : maxWindowExponent;
+    if (!gentle ||
+        fabsf(exponent - *windowExponent) > log10f(AUTORANGE_MAX_RATIO)) {
+      *windowExponent = exponent;
+    }
+  }
+  return;
 }
 
 void renderByPoints(float const *const data, size_t const dataLenght,
                     float const deltaX, int const screenWidth,
                     int const screenHeight, int const yMin, int const yMax) {
-  for (size_t i = 0; i < dataLenght; i++) {
-    float d = data[i];
-    float xPos = i * deltaX;
-    float yPos = (d - yMin) / (yMax - yMin) * screenHeight;
-    yPos = screenHeight - yPos;
-    DrawCircle(xPos, yPos, 2, DARKBLUE);
+  Vector2 points[POINT_BATCH];
+  for (size_t first = 0; first < dataLenght; first += POINT_BATCH) {
+    size_t const count = (dataLenght - first < POINT_BATCH)
+                             ? dataLenght - first
+                             : POINT_BATCH;
+    for (size_t i = 0; i < count; i++) {
+      float const d = data[first + i];
+      points[i] = (Vector2){.x = (first + i) * deltaX,
+                            .y = screenHeight *
+                                 (1 - (d - yMin) / (yMax - yMin))};
+    }
+    drawPointQuads(points, count, POINT_SIZE, DARKBLUE);
+  }
+  return;
+}
+
+void renderByPointsComplex(float const *const data, size_t const dataLenght,
+                           float const deltaX, int const screenWidth,
+                           int const screenHeight, int const yMin,
+                           int const yMax) {
+  Color const colors[] = {RED, BLUE};
+  Vector2 points[POINT_BATCH];
+  size_t const frames = dataLenght / 2;
+  for (size_t c = 0; c < 2; c++) {
+    for (size_t first = 0; first < frames; first += POINT_BATCH) {
+      size_t const count =
+          (frames - first < POINT_BATCH) ? frames - first : POINT_BATCH;
+      for (size_t i = 0; i < count; i++) {
+        size_t const sample = 2 * (first + i) + c;
+        float const d = data[sample];
+        points[i] = (Vector2){.x = sample * deltaX,
+                              .y = screenHeight *
+                                   (1 - (d - yMin) / (yMax - yMin))};
+      }
+      drawPointQuads(points, count, POINT_SIZE, colors[c]);
+    }
   }
   return;
 }
 
+void drawPointQuads(Vector2 const *const points, size_t const count,
+                    float const size, Color const color) {
+  // One 4 vertex quad per point in the rlgl batch, where DrawCircle
+  // tessellates dozens of triangles. The batch is flushed up front if the
+  // whole array does not fit, so it goes out in a single draw call.
+  float const half = size / 2;
+  rlCheckRenderBatchLimit((int)count * 4);
+  rlSetTexture(rlGetTextureIdDefault());
+  rlBegin(RL_QUADS);
+  rlColor4ub(color.r, color.g, color.b, color.a);
+  for (size_t i = 0; i < count; i++) {
+    float const x = points[i].x;
+    float const y = points[i].y;
+    rlVertex2f(x - half, y - half);
+    rlVertex2f(x - half, y + half);
+    rlVertex2f(x + half, y + half);
+    rlVertex2f(x + half, y - half);
+  }
+  rlEnd();
+  rlSetTexture(0);
+  return;
+}
+
 void renderByLines(float const *const data, size_t const dataLenght,
                    float const deltaX, int const screenWidth,
                    int const screenHeight, int const yMin, int const yMax) {
@@ -232,3 +1899,294 @@ void renderByLinesComplex(float const *const data, size_t const dataLenght,
   DrawLineStrip(pointsImag, dataLenght / 2, BLUE);
   return;
 }
+
+void renderInterpolated(float const *const data, size_t const points,
+                        size_t const channels, float const deltaX,
+                        float const channelShift, int const screenHeight,
+                        int const yMin, int const yMax) {
+  // Channel after channel, as written by Interpolator_run. Strips are cut
+  // to fit the rlgl batch, consecutive ones share their end point.
+  Color const colors[] = {BLACK, BLUE};
+  Color const complexColors[] = {RED, BLUE};
+  Vector2 strip[POINT_BATCH];
+  for (size_t ch = 0; ch < channels; ch++) {
+    float const *const values = data + ch * points;
+    for (size_t first = 0; first + 1 < points; first += POINT_BATCH - 1) {
+      size_t const count = (points - first < POINT_BATCH) ? points - first
+                                                          : POINT_BATCH;
+      for (size_t i = 0; i < count; i++) {
+        float const d = values[first + i];
+        strip[i] = (Vector2){
+            .x = (first + i) * deltaX + ch * channelShift,
+            .y = screenHeight * (1 - (d - yMin) / (yMax - yMin))};
+      }
+      DrawLineStrip(strip, count,
+                    (channels == 2) ? complexColors[ch] : colors[ch]);
+    }
+  }
+  return;
+}
+
+void renderEnvelope(float const *const lower, float const *const upper,
+                    size_t const points, size_t const channels,
+                    float const deltaX, float const channelShift,
+                    int const screenHeight, int const yMin, int const yMax) {
+  // One translucent quad between each pair of consecutive points, batched
+  // like the dots.
+  Color const colors[] = {BLACK, BLUE};
+  Color const complexColors[] = {RED, BLUE};
+  float const scale = screenHeight / (float)(yMax - yMin);
+  for (size_t ch = 0; ch < channels; ch++) {
+    Color const color = ColorAlpha(
+        (channels == 2) ? complexColors[ch] : colors[ch], ENVELOPE_ALPHA);
+    float const shift = ch * channelShift;
+    rlSetTexture(rlGetTextureIdDefault());
+    for (size_t first = 0; first + 1 < points; first += POINT_BATCH) {
+      size_t const count = (points - 1 - first < POINT_BATCH)
+                               ? points - 1 - first
+                               : POINT_BATCH;
+      rlCheckRenderBatchLimit((int)count * 4);
+      rlBegin(RL_QUADS);
+      rlColor4ub(color.r, color.g, color.b, color.a);
+      for (size_t i = first; i < first + count; i++) {
+        float const x0 = i * deltaX + shift;
+        float const x1 = x0 + deltaX;
+        rlVertex2f(x0, (yMax - upper[i * channels + ch]) * scale);
+        rlVertex2f(x0, (yMax - lower[i * channels + ch]) * scale);
+        rlVertex2f(x1, (yMax - lower[(i + 1) * channels + ch]) * scale);
+        rlVertex2f(x1, (yMax - upper[(i + 1) * channels + ch]) * scale);
+      }
+      rlEnd();
+    }
+    rlSetTexture(0);
+  }
+  return;
+}
+
+void renderPeakDetect(float const *const columnMin,
+                      float const *const columnMax, size_t const columns,
+                      size_t const channels, int const screenWidth,
+                      int const screenHeight, int const yMin, int const yMax) {
+  // Zig-zag between max and min of consecutive columns: 2 vertices per
+  // column whatever the number of samples behind it.
+  Color const colors[] = {BLACK, BLUE};
+  Color const complexColors[] = {RED, BLUE};
+  Vector2 points[2 * columns];
+  float const deltaX = screenWidth / (float)columns;
+  for (size_t ch = 0; ch < channels; ch++) {
+    for (size_t c = 0; c < columns; c++) {
+      float const dMax = columnMax[c * channels + ch];
+      float const dMin = columnMin[c * channels + ch];
+      float const x = c * deltaX;
+      size_t const first = 2 * c + (c & 1);
+      size_t const second = 2 * c + 1 - (c & 1);
+      points[first] = (Vector2){
+          .x = x, .y = screenHeight * (1 - (dMax - yMin) / (yMax - yMin))};
+      points[second] = (Vector2){
+          .x = x, .y = screenHeight * (1 - (dMin - yMin) / (yMax - yMin))};
+    }
+    DrawLineStrip(points, 2 * columns,
+                  (channels == 2) ? complexColors[ch] : colors[ch]);
+  }
+  return;
+}
+
+void renderDecimated(float const *const pointsX, float const *const pointsY,
+                     size_t const points, size_t const channels,
+                     size_t const frames, int const screenWidth,
+                     int const screenHeight, int const yMin, int const yMax) {
+  Color const colors[] = {BLACK, BLUE};
+  Color const complexColors[] = {RED, BLUE};
+  Vector2 strip[points];
+  float const deltaX = screenWidth / (float)frames;
+  for (size_t ch = 0; ch < channels; ch++) {
+    for (size_t i = 0; i < points; i++) {
+      float const d = pointsY[i * channels + ch];
+      strip[i] = (Vector2){.x = pointsX[i * channels + ch] * deltaX,
+                           .y = screenHeight * (1 - (d - yMin) / (yMax - yMin))};
+    }
+    DrawLineStrip(strip, points,
+                  (channels == 2) ? complexColors[ch] : colors[ch]);
+  }
+  return;
+}
+
+void renderSpectrum(float const *const columnDb, size_t const columns,
+                    int const screenWidth, int const screenHeight,
+                    float const dbMin, float const dbMax) {
+  Vector2 strip[columns];
+  float const deltaX = screenWidth / (float)columns;
+  for (size_t c = 0; c < columns; c++) {
+    float const db = columnDb[c];
+    strip[c] = (Vector2){.x = c * deltaX,
+                         .y = screenHeight * (dbMax - db) / (dbMax - dbMin)};
+  }
+  DrawLineStrip(strip, columns, DARKBLUE);
+  return;
+}
+
+bool followLiveView(LiveView *const view,
+                    AcquisitionTaskArgs *const acquisition,
+                    uint64_t const newest, size_t const frames,
+                    double const now) {
+  // Triggered windows end post-trigger frames after the trigger. Without
+  // trigger (AUTO timed out) the view sweeps: it jumps to the last complete
+  // window as soon as one is stored.
+  uint64_t const triggerCount = acquisition->triggerCount;
+  if (triggerCount != view->shownTriggerCount) {
+    view->shownTriggerCount = triggerCount;
+    view->lastTriggerTime = now;
+  }
+  bool const freeRun = acquisition->triggerMode == TRIGGER_MODE_AUTO &&
+                       now - view->lastTriggerTime > AUTO_TRIGGER_TIMEOUT_S;
+  uint64_t const preTrigger =
+      (uint64_t)(acquisition->triggerPosition * frames);
+  if (acquisition->running && freeRun) {
+    view->liveEnd = newest / frames * frames;
+  } else if (view->shownTriggerCount) {
+    view->liveEnd = acquisition->lastTrigger + (frames - preTrigger);
+  }
+  acquisition->freeRun = freeRun;
+  return freeRun;
+}
+
+int runHeadless(HeadlessArgs const *const args) {
+  AcquisitionTaskArgs *const acquisition = args->acquisition;
+  DeepMemory *const memory = acquisition->memory;
+  size_t const channels = memory->channels;
+  size_t const width = args->width;
+  size_t const frames = args->windowSamples / channels;
+  size_t const samples = frames * channels;
+  Framebuffer *framebuffer = Framebuffer_create(width, args->height);
+  uint8_t *persistPixels = calloc(width * args->height, 4);
+  // Up to one frame per column is drawn as is, above that two points per
+  // column (min and max) are.
+  float *scratch = calloc(2 * width * channels, sizeof(float));
+  float *pointsX = calloc(2 * width, sizeof(float));
+  float *pointsY = calloc(2 * width, sizeof(float));
+  assert(framebuffer && persistPixels && scratch && pointsX && pointsY);
+  uint8_t const background[4] = {245, 245, 245, 255};
+  uint8_t const graticule[4] = {200, 200, 200, 255};
+  acquisition->windowFrames = frames;
+  LiveView live = {.lastTriggerTime = monotonicSeconds()};
+  double decayTime = monotonicSeconds();
+  double renderTime = decayTime; // Of the last window, to detect a stall.
+  uint64_t renderedEnd = 0;
+  size_t rendered = 0;
+  double totalTime = 0;
+  double worstTime = 0;
+  printf("[HEADLESS] - rendering %zu frames of %zu samples\n", args->renders,
+         samples);
+  while (rendered < args->renders) {
+    // Sampled first: once set, the view below is the last one there will be.
+    bool const ended = acquisition->ended;
+    // Same view as the window, without panning.
+    uint64_t oldest;
+    uint64_t const newest = DeepMemory_range(memory, &oldest);
+    double const now = monotonicSeconds();
+    followLiveView(&live, acquisition, newest, frames, now);
+    uint64_t const viewEnd = live.liveEnd;
+    if (viewEnd == renderedEnd || viewEnd < oldest + frames ||
+        viewEnd > newest) {
+      if (ended || now - renderTime > HEADLESS_IDLE_S) {
+        printf("[HEADLESS] - %s after %zu of %zu frames\n",
+               (ended) ? "input ended" : "no new window", rendered,
+               args->renders);
+        break;
+      }
+      DeepMemory_wait(memory, newest, HEADLESS_WAIT_NS);
+      continue;
+    }
+    double const start = monotonicSeconds();
+    if (acquisition->persist && args->persistDecay > 0) {
+      Persistence_decay(acquisition->persistence,
+                        expf(-(start - decayTime) / args->persistDecay));
+    }
+    decayTime = start;
+    Framebuffer_clear(framebuffer, background);
+    Framebuffer_drawGraticule(framebuffer, GRATICULE_DIVISIONS_X,
+                              GRATICULE_DIVISIONS_Y, graticule);
+    if (acquisition->persist) {
+      Persistence_render(acquisition->persistence, persistPixels);
+      Framebuffer_blend(framebuffer, persistPixels);
+    } else if (!rasterizeWindow(framebuffer, memory, viewEnd - frames,
+                                frames, acquisition->yMin, acquisition->yMax,
+                                scratch, pointsX, pointsY)) {
+      // Overwritten since the range was read, the next window is tried.
+      continue;
+    }
+    double const elapsed = monotonicSeconds() - start;
+    totalTime += elapsed;
+    worstTime = (elapsed > worstTime) ? elapsed : worstTime;
+    renderedEnd = viewEnd;
+    renderTime = monotonicSeconds();
+    rendered++;
+  }
+  if (rendered) {
+    printf("[HEADLESS] - %zu frames, mean %.1f us, worst %.1f us\n", rendered,
+           totalTime / rendered * 1e6, worstTime * 1e6);
+  }
+  bool written = true;
+  if (args->pngPath && rendered) {
+    written = Framebuffer_writePng(framebuffer, args->pngPath);
+    if (!written) {
+      fprintf(stderr, "cannot write %s\n", args->pngPath);
+    }
+  }
+  free(pointsY);
+  free(pointsX);
+  free(scratch);
+  free(persistPixels);
+  Framebuffer_destroy(framebuffer);
+  return (written && rendered == args->renders) ? 0 : 1;
+}
+
+bool rasterizeWindow(Framebuffer *const framebuffer, DeepMemory *const memory,
+                     uint64_t const first, size_t const frames,
+                     float const yMin, float const yMax, float *const scratch,
+                     float *const pointsX, float *const pointsY) {
+  uint8_t const colors[][4] = {{0, 0, 0, 255}, {0, 121, 241, 255}};
+  uint8_t const complexColors[][4] = {{230, 41, 55, 255}, {0, 121, 241, 255}};
+  size_t const channels = memory->channels;
+  size_t const width = framebuffer->width;
+  float const height = framebuffer->height;
+  bool const decimate = frames > width;
+  float *const columnMin = scratch;
+  float *const columnMax = scratch + width * channels;
+  bool const fetched =
+      (decimate)
+          ? DeepMemory_reduce(memory, first, frames, width, columnMin,
+                              columnMax)
+          : DeepMemory_copy(memory, first, frames, scratch);
+  if (!fetched) {
+    return false;
+  }
+  size_t const points = (decimate) ? 2 * width : frames;
+  for (size_t ch = 0; ch < channels; ch++) {
+    for (size_t i = 0; i < points; i++) {
+      float d;
+      if (decimate) {
+        // Zig-zag between max and min of consecutive columns.
+        size_t const c = i / 2;
+        bool const high = (i & 1) == (c & 1);
+        d = (high) ? columnMax[c * channels + ch]
+                   : columnMin[c * channels + ch];
+        pointsX[i] = c;
+      } else {
+        d = scratch[i * channels + ch];
+        pointsX[i] = (i * channels + ch) * width / (float)(frames * channels);
+      }
+      pointsY[i] = height * (1 - (d - yMin) / (yMax - yMin));
+    }
+    Framebuffer_drawLineStrip(framebuffer, pointsX, pointsY, points,
+                              (channels == 2) ? complexColors[ch]
+                                              : colors[ch]);
+  }
+  return true;
+}
+
+double monotonicSeconds(void) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec + now.tv_nsec * 1e-9;
+}
@@ -0,0 +1,93 @@
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * CPU RGBA8 framebuffer, row major with row 0 at the top. Everything is
+ * drawn in software: it needs no window nor GPU, so the scope can render on
+ * display-less machines, dump frames to PNG and measure render cost
+ * deterministically. Colors are RGBA, blending is "source over".
+ */
+typedef struct {
+  size_t width;
+  size_t height;
+  uint8_t *pixels; // width * height * 4 bytes.
+} Framebuffer;
+
+/* ============================================ Public functions declaration */
+
+/**
+ * @brief Creates a new framebuffer. Allocates memory that must be freed with
+ * Framebuffer_destroy.
+ *
+ * @param[in] width: Width in pixels.
+ * @param[in] height: Height in pixels.
+ * @return Framebuffer instance, NULL if memory allocation errors.
+ */
+Framebuffer *Framebuffer_create(size_t const width, size_t const height);
+
+/**
+ * @brief Destroys instance. Frees all allocated memory during creation.
+ *
+ * @param[in] self: Framebuffer instance.
+ */
+void Framebuffer_destroy(Framebuffer *self);
+
+/**
+ * @brief Fills every pixel with color.
+ *
+ * @param[in] self: Framebuffer instance.
+ * @param[in] color: RGBA color.
+ */
+void Framebuffer_clear(Framebuffer *const self, uint8_t const color[4]);
+
+/**
+ * @brief Draws an oscilloscope graticule: a grid of divisionsX by divisionsY
+ * divisions, the center axes drawn solid and the other lines dotted.
+ *
+ * @param[in] self: Framebuffer instance.
+ * @param[in] divisionsX: Number of horizontal divisions.
+ * @param[in] divisionsY: Number of vertical divisions.
+ * @param[in] color: RGBA color.
+ */
+void Framebuffer_drawGraticule(Framebuffer *const self,
+                               size_t const divisionsX,
+                               size_t const divisionsY,
+                               uint8_t const color[4]);
+
+/**
+ * @brief Draws connected anti-aliased segments (Xiaolin Wu) through points.
+ * Parts outside the framebuffer are clipped.
+ *
+ * @param[in] self: Framebuffer instance.
+ * @param[in] x: Horizontal pixel coordinates, count values.
+ * @param[in] y: Vertical pixel coordinates, count values.
+ * @param[in] count: Number of points.
+ * @param[in] color: RGBA color.
+ */
+void Framebuffer_drawLineStrip(Framebuffer *const self, float const *const x,
+                               float const *const y, size_t const count,
+                               uint8_t const color[4]);
+
+/**
+ * @brief Blends a full size RGBA8 image (e.g. a rendered persistence map)
+ * over the framebuffer using its alpha channel.
+ *
+ * @param[in] self: Framebuffer instance.
+ * @param[in] rgba: Image pixels, width * height * 4 bytes, same layout.
+ */
+void Framebuffer_blend(Framebuffer *const self, uint8_t const *const rgba);
+
+/**
+ * @brief Writes the framebuffer to a PNG file (8 bit RGBA, uncompressed
+ * deflate blocks so that no compression library is needed).
+ *
+ * @param[in] self: Framebuffer instance.
+ * @param[in] path: Output file path.
+ * @return false if the file cannot be written.
+ */
+bool Framebuffer_writePng(Framebuffer const *const self,
+                          char const *const path);
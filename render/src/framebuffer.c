@@ -0,0 +1,319 @@
+
+#include "render/framebuffer.h"
+#include <assert.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#define dassert(exp) assert(exp)
+
+#define GRATICULE_DOT_SPACING 4
+// Stored deflate blocks hold at most 65535 bytes.
+#define PNG_STORED_BLOCK 65535
+
+static void blendPixel(Framebuffer *const self, long const x, long const y,
+                       uint8_t const color[4], float const coverage);
+static void drawSegment(Framebuffer *const self, float x0, float y0, float x1,
+                        float y1, uint8_t const color[4]);
+static uint32_t crc32Update(uint32_t crc, uint8_t const *const data,
+                            size_t const size);
+static bool writeChunk(FILE *const file, char const *const type,
+                       uint8_t const *const head, size_t const headSize,
+                       uint8_t const *const data, size_t const dataSize);
+static void putBe32(uint8_t *const dst, uint32_t const value);
+
+Framebuffer *Framebuffer_create(size_t const width, size_t const height) {
+  dassert(width > 0 && height > 0);
+  Framebuffer *self = calloc(1, sizeof(Framebuffer));
+  if (!self) {
+    return NULL;
+  }
+  self->width = width;
+  self->height = height;
+  self->pixels = calloc(width * height, 4);
+  if (!self->pixels) {
+    free(self);
+    return NULL;
+  }
+  return self;
+}
+
+void Framebuffer_destroy(Framebuffer *self) {
+  if (!self) {
+    return;
+  }
+  free(self->pixels);
+  free(self);
+  return;
+}
+
+void Framebuffer_clear(Framebuffer *const self, uint8_t const color[4]) {
+  size_t const count = self->width * self->height;
+  uint32_t pattern;
+  memcpy(&pattern, color, 4);
+  size_t i = 0;
+#if defined(__SSE2__)
+  __m128i const p = _mm_set1_epi32((int)pattern);
+  for (; i + 4 <= count; i += 4) {
+    _mm_storeu_si128((__m128i *)(self->pixels + i * 4), p);
+  }
+#endif
+  for (; i < count; i++) {
+    memcpy(self->pixels + i * 4, &pattern, 4);
+  }
+  return;
+}
+
+void Framebuffer_drawGraticule(Framebuffer *const self,
+                               size_t const divisionsX,
+                               size_t const divisionsY,
+                               uint8_t const color[4]) {
+  long const width = (long)self->width;
+  long const height = (long)self->height;
+  for (size_t d = 0; d <= divisionsX; d++) {
+    long x = (long)(d * (width - 1) / divisionsX);
+    long const step = (2 * d == divisionsX) ? 1 : GRATICULE_DOT_SPACING;
+    for (long y = 0; y < height; y += step) {
+      blendPixel(self, x, y, color, 1);
+    }
+  }
+  for (size_t d = 0; d <= divisionsY; d++) {
+    long y = (long)(d * (height - 1) / divisionsY);
+    long const step = (2 * d == divisionsY) ? 1 : GRATICULE_DOT_SPACING;
+    for (long x = 0; x < width; x += step) {
+      blendPixel(self, x, y, color, 1);
+    }
+  }
+  return;
+}
+
+void Framebuffer_drawLineStrip(Framebuffer *const self, float const *const x,
+                               float const *const y, size_t const count,
+                               uint8_t const color[4]) {
+  for (size_t i = 1; i < count; i++) {
+    drawSegment(self, x[i - 1], y[i - 1], x[i], y[i], color);
+  }
+  return;
+}
+
+void Framebuffer_blend(Framebuffer *const self, uint8_t const *const rgba) {
+  // dst = (dst * (255 - a) + src * a) / 255 per channel, the source alpha
+  // taken as 255 so that the result alpha is a + dst_a * (255 - a) / 255.
+  size_t const count = self->width * self->height;
+  uint8_t *const dst = self->pixels;
+  size_t i = 0;
+#if defined(__SSE2__)
+  __m128i const zero = _mm_setzero_si128();
+  __m128i const full = _mm_set1_epi16(255);
+  __m128i const round = _mm_set1_epi16(128);
+  __m128i const opaque = _mm_set1_epi32((int)0xff000000u);
+  for (; i + 4 <= count; i += 4) {
+    __m128i const s = _mm_loadu_si128((__m128i const *)(rgba + i * 4));
+    __m128i const d = _mm_loadu_si128((__m128i const *)(dst + i * 4));
+    __m128i const so = _mm_or_si128(s, opaque);
+    __m128i out[2];
+    for (int h = 0; h < 2; h++) {
+      __m128i const s16 = (h) ? _mm_unpackhi_epi8(so, zero)
+                              : _mm_unpacklo_epi8(so, zero);
+      __m128i const d16 = (h) ? _mm_unpackhi_epi8(d, zero)
+                              : _mm_unpacklo_epi8(d, zero);
+      __m128i a =
+          (h) ? _mm_unpackhi_epi8(s, zero) : _mm_unpacklo_epi8(s, zero);
+      a = _mm_shufflelo_epi16(a, _MM_SHUFFLE(3, 3, 3, 3));
+      a = _mm_shufflehi_epi16(a, _MM_SHUFFLE(3, 3, 3, 3));
+      __m128i const inverse = _mm_sub_epi16(full, a);
+      __m128i v = _mm_add_epi16(_mm_mullo_epi16(s16, a),
+                                _mm_mullo_epi16(d16, inverse));
+      // Exact division by 255 of v + 128 <= 65153.
+      v = _mm_add_epi16(v, round);
+      v = _mm_srli_epi16(_mm_add_epi16(v, _mm_srli_epi16(v, 8)), 8);
+      out[h] = v;
+    }
+    _mm_storeu_si128((__m128i *)(dst + i * 4),
+                     _mm_packus_epi16(out[0], out[1]));
+  }
+#endif
+  for (; i < count; i++) {
+    uint32_t const a = rgba[i * 4 + 3];
+    for (size_t c = 0; c < 4; c++) {
+      uint32_t const s = (c == 3) ? 255 : rgba[i * 4 + c];
+      uint32_t v = s * a + dst[i * 4 + c] * (255 - a) + 128;
+      dst[i * 4 + c] = (uint8_t)((v + (v >> 8)) >> 8);
+    }
+  }
+  return;
+}
+
+bool Framebuffer_writePng(Framebuffer const *const self,
+                          char const *const path) {
+  size_t const stride = 1 + self->width * 4;
+  size_t const rawSize = stride * self->height;
+  size_t const blocks = (rawSize + PNG_STORED_BLOCK - 1) / PNG_STORED_BLOCK;
+  size_t const idatSize = 2 + rawSize + 5 * blocks + 4;
+  // Scanlines with filter type 0, wrapped in stored deflate blocks.
+  uint8_t *const idat = malloc(idatSize);
+  FILE *const file = fopen(path, "wb");
+  if (!idat || !file) {
+    free(idat);
+    if (file) {
+      fclose(file);
+    }
+    return false;
+  }
+  uint8_t *out = idat;
+  *out++ = 0x78; // Deflate, 32K window.
+  *out++ = 0x01; // No compression level, header checksum.
+  uint32_t adlerA = 1;
+  uint32_t adlerB = 0;
+  size_t done = 0;
+  while (done < rawSize) {
+    size_t const left = rawSize - done;
+    size_t const size = (left < PNG_STORED_BLOCK) ? left : PNG_STORED_BLOCK;
+    *out++ = (done + size == rawSize) ? 1 : 0;
+    out[0] = (uint8_t)size;
+    out[1] = (uint8_t)(size >> 8);
+    out[2] = (uint8_t)~size;
+    out[3] = (uint8_t)(~size >> 8);
+    out += 4;
+    for (size_t i = done; i < done + size; i++) {
+      size_t const row = i / stride;
+      size_t const column = i % stride;
+      uint8_t const byte =
+          (column) ? self->pixels[row * self->width * 4 + column - 1] : 0;
+      *out++ = byte;
+      adlerA = (adlerA + byte) % 65521;
+      adlerB = (adlerB + adlerA) % 65521;
+    }
+    done += size;
+  }
+  putBe32(out, (adlerB << 16) | adlerA);
+  static uint8_t const signature[8] = {0x89, 'P', 'N', 'G',
+                                       '\r', '\n', 0x1a, '\n'};
+  uint8_t header[13];
+  putBe32(header, (uint32_t)self->width);
+  putBe32(header + 4, (uint32_t)self->height);
+  header[8] = 8;  // Bit depth.
+  header[9] = 6;  // RGBA.
+  header[10] = 0; // Deflate.
+  header[11] = 0; // Adaptive filtering.
+  header[12] = 0; // No interlace.
+  bool ok = fwrite(signature, 1, 8, file) == 8;
+  ok = ok && writeChunk(file, "IHDR", header, sizeof(header), NULL, 0);
+  ok = ok && writeChunk(file, "IDAT", NULL, 0, idat, idatSize);
+  ok = ok && writeChunk(file, "IEND", NULL, 0, NULL, 0);
+  ok = (fclose(file) == 0) && ok;
+  free(idat);
+  return ok;
+}
+
+/* Blends color over pixel (x, y) with weight coverage, ignoring pixels
+ * outside the framebuffer. */
+static void blendPixel(Framebuffer *const self, long const x, long const y,
+                       uint8_t const color[4], float const coverage) {
+  if (x < 0 || y < 0 || x >= (long)self->width || y >= (long)self->height) {
+    return;
+  }
+  uint8_t *const pixel = self->pixels + ((size_t)y * self->width + x) * 4;
+  float const a = coverage * color[3] / 255.0f;
+  for (size_t c = 0; c < 3; c++) {
+    pixel[c] = (uint8_t)(pixel[c] + (color[c] - pixel[c]) * a + 0.5f);
+  }
+  pixel[3] = (uint8_t)(pixel[3] + (255 - pixel[3]) * a + 0.5f);
+  return;
+}
+
+/* Xiaolin Wu's anti-aliased line: along the major axis every step covers
+ * the two pixels straddling the line, weighted by distance. */
+static void drawSegment(Framebuffer *const self, float x0, float y0, float x1,
+                        float y1, uint8_t const color[4]) {
+  if (!isfinite(x0) || !isfinite(y0) || !isfinite(x1) || !isfinite(y1)) {
+    return;
+  }
+  bool const steep = fabsf(y1 - y0) > fabsf(x1 - x0);
+  float t;
+  if (steep) {
+    t = x0, x0 = y0, y0 = t;
+    t = x1, x1 = y1, y1 = t;
+  }
+  if (x0 > x1) {
+    t = x0, x0 = x1, x1 = t;
+    t = y0, y0 = y1, y1 = t;
+  }
+  float const gradient = (x1 - x0 > 0) ? (y1 - y0) / (x1 - x0) : 1;
+  // Only the major axis range inside the framebuffer is walked.
+  float const limit = (steep) ? self->height : self->width;
+  float const first = (x0 > -1) ? x0 : -1;
+  float const last = (x1 < limit) ? x1 : limit;
+  float const start = roundf(x0);
+  float const end = roundf(x1);
+  for (long x = lroundf(first); x <= lroundf(last); x++) {
+    float const y = y0 + gradient * (x - x0);
+    float const base = floorf(y);
+    float const frac = y - base;
+    // End pixels are only partly covered by the segment.
+    float gap = 1;
+    if (x == start) {
+      gap = 0.5f - (x0 - x);
+    } else if (x == end) {
+      gap = 0.5f + (x1 - x);
+    }
+    gap = (x0 == x1) ? 1 : gap;
+    long const b = (long)base;
+    if (steep) {
+      blendPixel(self, b, x, color, (1 - frac) * gap);
+      blendPixel(self, b + 1, x, color, frac * gap);
+    } else {
+      blendPixel(self, x, b, color, (1 - frac) * gap);
+      blendPixel(self, x, b + 1, color, frac * gap);
+    }
+  }
+  return;
+}
+
+static uint32_t crc32Update(uint32_t crc, uint8_t const *const data,
+                            size_t const size) {
+  static uint32_t table[256];
+  if (!table[1]) {
+    for (uint32_t n = 0; n < 256; n++) {
+      uint32_t c = n;
+      for (int k = 0; k < 8; k++) {
+        c = (c & 1) ? 0xedb88320u ^ (c >> 1) : c >> 1;
+      }
+      table[n] = c;
+    }
+  }
+  for (size_t i = 0; i < size; i++) {
+    crc = table[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+  }
+  return crc;
+}
+
+/* Writes a chunk whose data is head followed by data. */
+static bool writeChunk(FILE *const file, char const *const type,
+                       uint8_t const *const head, size_t const headSize,
+                       uint8_t const *const data, size_t const dataSize) {
+  uint8_t prefix[8];
+  putBe32(prefix, (uint32_t)(headSize + dataSize));
+  memcpy(prefix + 4, type, 4);
+  uint32_t crc = crc32Update(0xffffffffu, prefix + 4, 4);
+  crc = crc32Update(crc, head, headSize);
+  crc = crc32Update(crc, data, dataSize);
+  uint8_t suffix[4];
+  putBe32(suffix, crc ^ 0xffffffffu);
+  return fwrite(prefix, 1, 8, file) == 8 &&
+         fwrite(head, 1, headSize, file) == headSize &&
+         fwrite(data, 1, dataSize, file) == dataSize &&
+         fwrite(suffix, 1, 4, file) == 4;
+}
+
+static void putBe32(uint8_t *const dst, uint32_t const value) {
+  dst[0] = (uint8_t)(value >> 24);
+  dst[1] = (uint8_t)(value >> 16);
+  dst[2] = (uint8_t)(value >> 8);
+  dst[3] = (uint8_t)value;
+  return;
+}
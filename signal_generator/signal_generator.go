@@ -1,6 +1,7 @@
 package main
 
 import (
+	"bytes"
 	"encoding/binary"
 	"flag"
 	"fmt"
@@ -97,12 +98,17 @@ type noiseFunc func() float32
 
 func main() {
 	ipFlag := flag.String("ip", "127.0.0.1:6969", "target ip address in the format: x.x.x.x:port")
-	protoFlag := flag.String("proto", "tcp", "ip transport protocol to use: \"tcp\" or \"udp\"")
+	protoFlag := flag.String("proto", "tcp", "transport protocol to use: \"tcp\", \"udp\" or \"unixpacket\" (ip is then a socket path)")
 	waveFlag := flag.String("wave", "sine", "Wave form: \"sine\" \"exp\" \"square\" \"mSequence\"")
 	freqFlag := flag.Float64("freq", 1, "Wave frequency in Hz")
 	noiseFlag := flag.Float64("noise", 0, "Noise level")
 	sampleFreqFlag := flag.Float64("sampleFreq", 100000, "Sample frequency in Hz")
+	batchFlag := flag.Int("batch", 1, "Samples sent per write (one datagram per write with udp)")
 	flag.Parse()
+	if *batchFlag < 1 {
+		fmt.Println("batch must be at least 1")
+		return
+	}
 
 	conn, err := net.Dial(*protoFlag, *ipFlag)
 	if err != nil {
@@ -139,16 +145,22 @@ func main() {
 		noise = func() float32 { return float32(*noiseFlag) * (2*rand.Float32() - 1) }
 	}
 	fmt.Printf("Sending data...")
+	var batch bytes.Buffer
 	for {
 		numbers := numberGen(n)
 		for _, n := range numbers {
 			n += noise()
-			err := binary.Write(conn, binary.LittleEndian, n)
-			if err != nil {
-				panic(err)
-			}
+			binary.Write(&batch, binary.LittleEndian, n)
 		}
-		time.Sleep(deltaT)
 		n += 1
+		if n%int64(*batchFlag) != 0 {
+			continue
+		}
+		_, err := conn.Write(batch.Bytes())
+		if err != nil {
+			panic(err)
+		}
+		batch.Reset()
+		time.Sleep(deltaT * time.Duration(*batchFlag))
 	}
 }